@@ -0,0 +1,612 @@
+// ----------------------------------------------------
+// AABBTree.cpp
+// Dynamic AABB tree, incremental insert/remove/refit
+// ----------------------------------------------------
+
+#include "AABBTree.h"
+#include <math.h>
+
+static float Area(const vec3& min, const vec3& max)
+{
+	float x = max.x - min.x;
+	float y = max.y - min.y;
+	float z = max.z - min.z;
+	return 2.0f * (x * y + y * z + z * x);
+}
+
+static void Combine(const vec3& minA, const vec3& maxA, const vec3& minB, const vec3& maxB, vec3& min, vec3& max)
+{
+	min.Set(fminf(minA.x, minB.x), fminf(minA.y, minB.y), fminf(minA.z, minB.z));
+	max.Set(fmaxf(maxA.x, maxB.x), fmaxf(maxA.y, maxB.y), fmaxf(maxA.z, maxB.z));
+}
+
+static bool Contains(const vec3& outerMin, const vec3& outerMax, const vec3& min, const vec3& max)
+{
+	return outerMin.x <= min.x && outerMin.y <= min.y && outerMin.z <= min.z &&
+		max.x <= outerMax.x && max.y <= outerMax.y && max.z <= outerMax.z;
+}
+
+static bool Overlaps(const vec3& minA, const vec3& maxA, const vec3& minB, const vec3& maxB)
+{
+	return minA.x <= maxB.x && minB.x <= maxA.x &&
+		minA.y <= maxB.y && minB.y <= maxA.y &&
+		minA.z <= maxB.z && minB.z <= maxA.z;
+}
+
+// ---------------------------------------------
+AABBTree::AABBTree()
+{}
+
+// ---------------------------------------------
+AABBTree::~AABBTree()
+{}
+
+// ---------------------------------------------
+int AABBTree::CreateProxy(const vec3& min, const vec3& max, void* data)
+{
+	int proxy = AllocateNode();
+	Node& node = nodes[proxy];
+
+	vec3 margin(AABB_TREE_MARGIN, AABB_TREE_MARGIN, AABB_TREE_MARGIN);
+	node.min = min - margin;
+	node.max = max + margin;
+	node.data = data;
+	node.height = 0;
+
+	InsertLeaf(proxy);
+	++proxyCount;
+
+	return proxy;
+}
+
+// ---------------------------------------------
+void AABBTree::DestroyProxy(int proxy)
+{
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	--proxyCount;
+}
+
+// ---------------------------------------------
+bool AABBTree::MoveProxy(int proxy, const vec3& min, const vec3& max)
+{
+	Node& node = nodes[proxy];
+	if (Contains(node.min, node.max, min, max))
+	{
+		return false;
+	}
+
+	RemoveLeaf(proxy);
+
+	vec3 margin(AABB_TREE_MARGIN, AABB_TREE_MARGIN, AABB_TREE_MARGIN);
+	nodes[proxy].min = min - margin;
+	nodes[proxy].max = max + margin;
+
+	InsertLeaf(proxy);
+	return true;
+}
+
+// ---------------------------------------------
+void* AABBTree::GetData(int proxy) const
+{
+	return nodes[proxy].data;
+}
+
+// ---------------------------------------------
+uint AABBTree::GetProxyCount() const
+{
+	return proxyCount;
+}
+
+// ---------------------------------------------
+int AABBTree::GetHeight() const
+{
+	return root != AABB_NULL_NODE ? nodes[root].height : 0;
+}
+
+// ---------------------------------------------
+void AABBTree::Clear()
+{
+	nodes.clear();
+	root = AABB_NULL_NODE;
+	freeList = AABB_NULL_NODE;
+	proxyCount = 0;
+}
+
+// ---------------------------------------------
+void AABBTree::QueryAABB(const vec3& min, const vec3& max, std::vector<void*>& results) const
+{
+	if (root == AABB_NULL_NODE)
+	{
+		return;
+	}
+
+	stack.clear();
+	stack.push_back(root);
+
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+
+		if (Overlaps(node.min, node.max, min, max))
+		{
+			if (node.IsLeaf())
+			{
+				results.push_back(node.data);
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+}
+
+// ---------------------------------------------
+void AABBTree::QuerySphere(const vec3& center, float radius, std::vector<void*>& results) const
+{
+	if (root == AABB_NULL_NODE)
+	{
+		return;
+	}
+
+	float radiusSq = radius * radius;
+
+	stack.clear();
+	stack.push_back(root);
+
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+
+		// Squared distance from the center to the closest point of the box
+		float dx = fmaxf(fmaxf(node.min.x - center.x, 0.0f), center.x - node.max.x);
+		float dy = fmaxf(fmaxf(node.min.y - center.y, 0.0f), center.y - node.max.y);
+		float dz = fmaxf(fmaxf(node.min.z - center.z, 0.0f), center.z - node.max.z);
+
+		if (dx * dx + dy * dy + dz * dz <= radiusSq)
+		{
+			if (node.IsLeaf())
+			{
+				results.push_back(node.data);
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+}
+
+// ---------------------------------------------
+// A node fully inside the frustum adds its whole subtree without more plane tests
+void AABBTree::QueryFrustum(const float planes[6][4], std::vector<void*>& results) const
+{
+	if (root == AABB_NULL_NODE)
+	{
+		return;
+	}
+
+	// Bit 30 of a stack entry marks subtrees already known to be inside
+	const int inside = 1 << 30;
+
+	stack.clear();
+	stack.push_back(root);
+
+	while (!stack.empty())
+	{
+		int entry = stack.back();
+		stack.pop_back();
+
+		bool fullyInside = (entry & inside) != 0;
+		const Node& node = nodes[entry & ~inside];
+
+		if (fullyInside == false)
+		{
+			bool outside = false;
+			fullyInside = true;
+
+			for (uint i = 0; i < 6 && !outside; ++i)
+			{
+				const float* n = planes[i];
+				float nearest = n[0] * (n[0] > 0.0f ? node.min.x : node.max.x) + n[1] * (n[1] > 0.0f ? node.min.y : node.max.y) + n[2] * (n[2] > 0.0f ? node.min.z : node.max.z);
+				float farthest = n[0] * (n[0] > 0.0f ? node.max.x : node.min.x) + n[1] * (n[1] > 0.0f ? node.max.y : node.min.y) + n[2] * (n[2] > 0.0f ? node.max.z : node.min.z);
+
+				if (nearest - n[3] > 0.0f)
+				{
+					outside = true;
+				}
+				else if (farthest - n[3] > 0.0f)
+				{
+					fullyInside = false;
+				}
+			}
+
+			if (outside)
+			{
+				continue;
+			}
+		}
+
+		if (node.IsLeaf())
+		{
+			results.push_back(node.data);
+		}
+		else
+		{
+			stack.push_back(node.child1 | (fullyInside ? inside : 0));
+			stack.push_back(node.child2 | (fullyInside ? inside : 0));
+		}
+	}
+}
+
+// ---------------------------------------------
+// Slab test against every node box, direction doesn't need to be normalized
+void AABBTree::QueryRay(const vec3& origin, const vec3& direction, float maxDistance, std::vector<void*>& results) const
+{
+	if (root == AABB_NULL_NODE)
+	{
+		return;
+	}
+
+	float length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+	if (length == 0.0f)
+	{
+		return;
+	}
+
+	float dir[3] = { direction.x / length, direction.y / length, direction.z / length };
+	float start[3] = { origin.x, origin.y, origin.z };
+
+	stack.clear();
+	stack.push_back(root);
+
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+
+		float low[3] = { node.min.x, node.min.y, node.min.z };
+		float high[3] = { node.max.x, node.max.y, node.max.z };
+		float tMin = 0.0f;
+		float tMax = maxDistance;
+		bool hit = true;
+
+		for (uint axis = 0; axis < 3 && hit; ++axis)
+		{
+			if (fabsf(dir[axis]) < 1e-8f)
+			{
+				hit = start[axis] >= low[axis] && start[axis] <= high[axis];
+			}
+			else
+			{
+				float t1 = (low[axis] - start[axis]) / dir[axis];
+				float t2 = (high[axis] - start[axis]) / dir[axis];
+				tMin = fmaxf(tMin, fminf(t1, t2));
+				tMax = fminf(tMax, fmaxf(t1, t2));
+				hit = tMin <= tMax;
+			}
+		}
+
+		if (hit)
+		{
+			if (node.IsLeaf())
+			{
+				results.push_back(node.data);
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+}
+
+// ---------------------------------------------
+int AABBTree::AllocateNode()
+{
+	int node;
+	if (freeList != AABB_NULL_NODE)
+	{
+		node = freeList;
+		freeList = nodes[node].parent;
+	}
+	else
+	{
+		node = nodes.size();
+		nodes.push_back(Node());
+	}
+
+	nodes[node].parent = AABB_NULL_NODE;
+	nodes[node].child1 = AABB_NULL_NODE;
+	nodes[node].child2 = AABB_NULL_NODE;
+	nodes[node].height = 0;
+	nodes[node].data = nullptr;
+
+	return node;
+}
+
+// ---------------------------------------------
+void AABBTree::FreeNode(int node)
+{
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	freeList = node;
+}
+
+// ---------------------------------------------
+void AABBTree::InsertLeaf(int leaf)
+{
+	if (root == AABB_NULL_NODE)
+	{
+		root = leaf;
+		nodes[root].parent = AABB_NULL_NODE;
+		return;
+	}
+
+	// Walk down towards the sibling that grows the total area the least
+	vec3 leafMin = nodes[leaf].min;
+	vec3 leafMax = nodes[leaf].max;
+	int index = root;
+
+	while (nodes[index].IsLeaf() == false)
+	{
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+
+		float area = Area(nodes[index].min, nodes[index].max);
+
+		vec3 combinedMin, combinedMax;
+		Combine(nodes[index].min, nodes[index].max, leafMin, leafMax, combinedMin, combinedMax);
+		float combinedArea = Area(combinedMin, combinedMax);
+
+		// Cost of making a new parent for this node and the new leaf
+		float cost = 2.0f * combinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float childCost[2];
+		int children[2] = { child1, child2 };
+		for (uint i = 0; i < 2; ++i)
+		{
+			const Node& child = nodes[children[i]];
+			Combine(leafMin, leafMax, child.min, child.max, combinedMin, combinedMax);
+
+			if (child.IsLeaf())
+			{
+				childCost[i] = Area(combinedMin, combinedMax) + inheritanceCost;
+			}
+			else
+			{
+				childCost[i] = Area(combinedMin, combinedMax) - Area(child.min, child.max) + inheritanceCost;
+			}
+		}
+
+		if (cost < childCost[0] && cost < childCost[1])
+		{
+			break;
+		}
+
+		index = childCost[0] < childCost[1] ? child1 : child2;
+	}
+
+	int sibling = index;
+
+	int oldParent = nodes[sibling].parent;
+	int newParent = AllocateNode();
+	nodes[newParent].parent = oldParent;
+	Combine(leafMin, leafMax, nodes[sibling].min, nodes[sibling].max, nodes[newParent].min, nodes[newParent].max);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent != AABB_NULL_NODE)
+	{
+		if (nodes[oldParent].child1 == sibling)
+		{
+			nodes[oldParent].child1 = newParent;
+		}
+		else
+		{
+			nodes[oldParent].child2 = newParent;
+		}
+	}
+	else
+	{
+		root = newParent;
+	}
+
+	Refit(nodes[leaf].parent);
+}
+
+// ---------------------------------------------
+void AABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == root)
+	{
+		root = AABB_NULL_NODE;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	if (grandParent != AABB_NULL_NODE)
+	{
+		// The sibling takes the parent's place
+		if (nodes[grandParent].child1 == parent)
+		{
+			nodes[grandParent].child1 = sibling;
+		}
+		else
+		{
+			nodes[grandParent].child2 = sibling;
+		}
+		nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+
+		Refit(grandParent);
+	}
+	else
+	{
+		root = sibling;
+		nodes[sibling].parent = AABB_NULL_NODE;
+		FreeNode(parent);
+	}
+}
+
+// ---------------------------------------------
+// Walks up to the root fixing boxes and heights, rotating where unbalanced
+void AABBTree::Refit(int index)
+{
+	while (index != AABB_NULL_NODE)
+	{
+		index = Balance(index);
+
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+
+		nodes[index].height = 1 + (nodes[child1].height > nodes[child2].height ? nodes[child1].height : nodes[child2].height);
+		Combine(nodes[child1].min, nodes[child1].max, nodes[child2].min, nodes[child2].max, nodes[index].min, nodes[index].max);
+
+		index = nodes[index].parent;
+	}
+}
+
+// ---------------------------------------------
+// Rotates the taller grandchild up when A's children differ in height by more than one
+// Returns the node now at A's position
+int AABBTree::Balance(int iA)
+{
+	Node* A = &nodes[iA];
+	if (A->IsLeaf() || A->height < 2)
+	{
+		return iA;
+	}
+
+	int iB = A->child1;
+	int iC = A->child2;
+	Node* B = &nodes[iB];
+	Node* C = &nodes[iC];
+
+	int balance = C->height - B->height;
+
+	// Rotate C up
+	if (balance > 1)
+	{
+		int iF = C->child1;
+		int iG = C->child2;
+		Node* F = &nodes[iF];
+		Node* G = &nodes[iG];
+
+		C->child1 = iA;
+		C->parent = A->parent;
+		A->parent = iC;
+
+		if (C->parent != AABB_NULL_NODE)
+		{
+			if (nodes[C->parent].child1 == iA)
+			{
+				nodes[C->parent].child1 = iC;
+			}
+			else
+			{
+				nodes[C->parent].child2 = iC;
+			}
+		}
+		else
+		{
+			root = iC;
+		}
+
+		if (F->height > G->height)
+		{
+			C->child2 = iF;
+			A->child2 = iG;
+			G->parent = iA;
+			Combine(B->min, B->max, G->min, G->max, A->min, A->max);
+			Combine(A->min, A->max, F->min, F->max, C->min, C->max);
+
+			A->height = 1 + (B->height > G->height ? B->height : G->height);
+			C->height = 1 + (A->height > F->height ? A->height : F->height);
+		}
+		else
+		{
+			C->child2 = iG;
+			A->child2 = iF;
+			F->parent = iA;
+			Combine(B->min, B->max, F->min, F->max, A->min, A->max);
+			Combine(A->min, A->max, G->min, G->max, C->min, C->max);
+
+			A->height = 1 + (B->height > F->height ? B->height : F->height);
+			C->height = 1 + (A->height > G->height ? A->height : G->height);
+		}
+
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1)
+	{
+		int iD = B->child1;
+		int iE = B->child2;
+		Node* D = &nodes[iD];
+		Node* E = &nodes[iE];
+
+		B->child1 = iA;
+		B->parent = A->parent;
+		A->parent = iB;
+
+		if (B->parent != AABB_NULL_NODE)
+		{
+			if (nodes[B->parent].child1 == iA)
+			{
+				nodes[B->parent].child1 = iB;
+			}
+			else
+			{
+				nodes[B->parent].child2 = iB;
+			}
+		}
+		else
+		{
+			root = iB;
+		}
+
+		if (D->height > E->height)
+		{
+			B->child2 = iD;
+			A->child1 = iE;
+			E->parent = iA;
+			Combine(C->min, C->max, E->min, E->max, A->min, A->max);
+			Combine(A->min, A->max, D->min, D->max, B->min, B->max);
+
+			A->height = 1 + (C->height > E->height ? C->height : E->height);
+			B->height = 1 + (A->height > D->height ? A->height : D->height);
+		}
+		else
+		{
+			B->child2 = iE;
+			A->child1 = iD;
+			D->parent = iA;
+			Combine(C->min, C->max, D->min, D->max, A->min, A->max);
+			Combine(A->min, A->max, E->min, E->max, B->min, B->max);
+
+			A->height = 1 + (C->height > D->height ? C->height : D->height);
+			B->height = 1 + (A->height > E->height ? A->height : E->height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
@@ -0,0 +1,77 @@
+#ifndef __AABBTREE_H__
+#define __AABBTREE_H__
+
+#include "Globals.h"
+#include "glmath.h"
+#include <vector>
+
+#define AABB_NULL_NODE -1
+#define AABB_TREE_MARGIN 0.1f
+
+// ----------------------------------------------------
+// Dynamic bounding volume hierarchy: leaves hold fattened
+// boxes so small moves don't touch the tree, inserts pick
+// the sibling with the lowest area cost and rotations
+// keep the height balanced
+// ----------------------------------------------------
+class AABBTree
+{
+public:
+
+	AABBTree();
+	~AABBTree();
+
+	int CreateProxy(const vec3& min, const vec3& max, void* data);
+	void DestroyProxy(int proxy);
+
+	// Returns true when the leaf had to be reinserted
+	bool MoveProxy(int proxy, const vec3& min, const vec3& max);
+
+	void* GetData(int proxy) const;
+	uint GetProxyCount() const;
+	int GetHeight() const;
+	void Clear();
+
+	// Append the data of every leaf whose fat box overlaps the volume
+	void QueryAABB(const vec3& min, const vec3& max, std::vector<void*>& results) const;
+	void QuerySphere(const vec3& center, float radius, std::vector<void*>& results) const;
+	// Outward plane normal and distance per row, as ModuleCamera3D::GetFrustumPlanes gives them
+	void QueryFrustum(const float planes[6][4], std::vector<void*>& results) const;
+	void QueryRay(const vec3& origin, const vec3& direction, float maxDistance, std::vector<void*>& results) const;
+
+private:
+
+	struct Node
+	{
+		vec3 min, max;
+		void* data;
+		int parent;
+		int child1;
+		int child2;
+		int height; // leaf = 0, free node = -1
+
+		bool IsLeaf() const
+		{
+			return child1 == AABB_NULL_NODE;
+		}
+	};
+
+	int AllocateNode();
+	void FreeNode(int node);
+
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int Balance(int node);
+	void Refit(int node);
+
+private:
+
+	std::vector<Node> nodes;
+	int root = AABB_NULL_NODE;
+	int freeList = AABB_NULL_NODE;
+	uint proxyCount = 0;
+
+	mutable std::vector<int> stack;
+};
+
+#endif // __AABBTREE_H__
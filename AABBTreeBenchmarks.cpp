@@ -0,0 +1,329 @@
+// ----------------------------------------------------
+// AABBTreeBenchmarks.cpp
+// AABB tree queries over a large scene against testing
+// every box, timed and checked for matching results
+// ----------------------------------------------------
+
+#include "MicroBenchmark.h"
+#include "AABBTree.h"
+#include <vector>
+#include <algorithm>
+
+#define AABB_BENCH_OBJECTS 100000
+// Distinct queries of each kind, checked and timed one per repeat
+#define AABB_BENCH_QUERIES 200
+#define AABB_BENCH_WORLD 500.0f
+#define AABB_BENCH_QUERY_SIZE 25.0f
+
+struct BenchBox
+{
+	vec3 min, max;
+};
+
+// Camera at position looking down -Z, outward planes as AABBTree::QueryFrustum takes them
+static void FrustumPlanes(const vec3& position, float planes[6][4])
+{
+	const float halfFov = 30.0f * DEGTORAD;
+	const float aspect = 16.0f / 9.0f;
+	const float nearPlane = 0.1f, farPlane = 300.0f;
+
+	float c = cosf(halfFov), s = sinf(halfFov);
+	float halfHorizontal = atanf(tanf(halfFov) * aspect);
+	float ch = cosf(halfHorizontal), sh = sinf(halfHorizontal);
+
+	vec3 normals[6] = { vec3(ch, 0.0f, sh), vec3(-ch, 0.0f, sh), vec3(0.0f, c, s), vec3(0.0f, -c, s), vec3(0.0f, 0.0f, 1.0f), vec3(0.0f, 0.0f, -1.0f) };
+	float distances[6] = { 0.0f, 0.0f, 0.0f, 0.0f, -nearPlane, farPlane };
+
+	for (uint i = 0; i < 6; ++i)
+	{
+		planes[i][0] = normals[i].x;
+		planes[i][1] = normals[i].y;
+		planes[i][2] = normals[i].z;
+		planes[i][3] = distances[i] + dot(normals[i], position);
+	}
+}
+
+// ---------------------------------------------
+// Brute force tests, the same math AABBTree uses per node on the fat boxes
+static bool BoxOverlaps(const BenchBox& box, const vec3& min, const vec3& max)
+{
+	return box.min.x <= max.x && min.x <= box.max.x &&
+		box.min.y <= max.y && min.y <= box.max.y &&
+		box.min.z <= max.z && min.z <= box.max.z;
+}
+
+static bool BoxInSphere(const BenchBox& box, const vec3& center, float radius)
+{
+	float dx = fmaxf(fmaxf(box.min.x - center.x, 0.0f), center.x - box.max.x);
+	float dy = fmaxf(fmaxf(box.min.y - center.y, 0.0f), center.y - box.max.y);
+	float dz = fmaxf(fmaxf(box.min.z - center.z, 0.0f), center.z - box.max.z);
+
+	return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+static bool BoxInFrustum(const BenchBox& box, const float planes[6][4])
+{
+	for (uint i = 0; i < 6; ++i)
+	{
+		const float* n = planes[i];
+		float nearest = n[0] * (n[0] > 0.0f ? box.min.x : box.max.x) + n[1] * (n[1] > 0.0f ? box.min.y : box.max.y) + n[2] * (n[2] > 0.0f ? box.min.z : box.max.z);
+
+		if (nearest - n[3] > 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool BoxOnRay(const BenchBox& box, const vec3& origin, const vec3& direction, float maxDistance)
+{
+	float length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+	float dir[3] = { direction.x / length, direction.y / length, direction.z / length };
+	float start[3] = { origin.x, origin.y, origin.z };
+	float low[3] = { box.min.x, box.min.y, box.min.z };
+	float high[3] = { box.max.x, box.max.y, box.max.z };
+	float tMin = 0.0f;
+	float tMax = maxDistance;
+
+	for (uint axis = 0; axis < 3; ++axis)
+	{
+		if (fabsf(dir[axis]) < 1e-8f)
+		{
+			if (start[axis] < low[axis] || start[axis] > high[axis])
+			{
+				return false;
+			}
+		}
+		else
+		{
+			float t1 = (low[axis] - start[axis]) / dir[axis];
+			float t2 = (high[axis] - start[axis]) / dir[axis];
+			tMin = fmaxf(tMin, fminf(t1, t2));
+			tMax = fminf(tMax, fmaxf(t1, t2));
+
+			if (tMin > tMax)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// ---------------------------------------------
+// Runs every query through the tree and through brute force, the result sets must be equal
+template<class TREE, class BRUTE>
+static void CheckQueries(MicroBenchmark& bench, const char* name, const std::vector<BenchBox>& boxes, TREE tree, BRUTE brute)
+{
+	std::vector<void*> fromTree, fromBrute;
+	uint mismatches = 0;
+
+	for (uint q = 0; q < AABB_BENCH_QUERIES; ++q)
+	{
+		fromTree.clear();
+		fromBrute.clear();
+
+		tree(q, fromTree);
+		for (uint i = 0; i < boxes.size(); ++i)
+		{
+			if (brute(q, boxes[i]))
+			{
+				fromBrute.push_back((void*)&boxes[i]);
+			}
+		}
+
+		std::sort(fromTree.begin(), fromTree.end());
+		std::sort(fromBrute.begin(), fromBrute.end());
+
+		if (fromTree != fromBrute)
+		{
+			++mismatches;
+		}
+	}
+
+	// Error is the number of queries whose results differ
+	bench.Check("aabbtree", name, mismatches == 0, mismatches);
+}
+
+// ---------------------------------------------
+void RunAABBTreeBenchmarks(MicroBenchmark& bench)
+{
+	const uint count = AABB_BENCH_OBJECTS;
+
+	uint seed = 98765u;
+	std::vector<BenchBox> boxes(count);
+	std::vector<vec3> tightMin(count), tightMax(count);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		vec3 center = RandomVec3(seed, -AABB_BENCH_WORLD, AABB_BENCH_WORLD);
+		vec3 half = RandomVec3(seed, 0.5f, 2.0f);
+		tightMin[i] = center - half;
+		tightMax[i] = center + half;
+	}
+
+	AABBTree tree;
+	for (uint i = 0; i < count; ++i)
+	{
+		tree.CreateProxy(tightMin[i], tightMax[i], &boxes[i]);
+	}
+
+	// Brute force tests the same fattened boxes the leaves hold
+	vec3 margin(AABB_TREE_MARGIN, AABB_TREE_MARGIN, AABB_TREE_MARGIN);
+	for (uint i = 0; i < count; ++i)
+	{
+		boxes[i].min = tightMin[i] - margin;
+		boxes[i].max = tightMax[i] + margin;
+	}
+
+	LOG("AABB tree with %u proxies, height %d", tree.GetProxyCount(), tree.GetHeight());
+
+	// Queries
+	std::vector<vec3> boxMin(AABB_BENCH_QUERIES), boxMax(AABB_BENCH_QUERIES);
+	std::vector<vec3> sphereCenters(AABB_BENCH_QUERIES), cameras(AABB_BENCH_QUERIES);
+	std::vector<vec3> rayOrigins(AABB_BENCH_QUERIES), rayDirections(AABB_BENCH_QUERIES);
+
+	for (uint q = 0; q < AABB_BENCH_QUERIES; ++q)
+	{
+		vec3 center = RandomVec3(seed, -AABB_BENCH_WORLD, AABB_BENCH_WORLD);
+		vec3 half(AABB_BENCH_QUERY_SIZE, AABB_BENCH_QUERY_SIZE, AABB_BENCH_QUERY_SIZE);
+		boxMin[q] = center - half;
+		boxMax[q] = center + half;
+
+		sphereCenters[q] = RandomVec3(seed, -AABB_BENCH_WORLD, AABB_BENCH_WORLD);
+		cameras[q] = RandomVec3(seed, -AABB_BENCH_WORLD, AABB_BENCH_WORLD);
+		rayOrigins[q] = RandomVec3(seed, -AABB_BENCH_WORLD, AABB_BENCH_WORLD);
+
+		vec3 direction = RandomVec3(seed, -1.0f, 1.0f);
+		rayDirections[q] = length2(direction) < 0.01f ? vec3(1.0f, 0.0f, 0.0f) : direction;
+	}
+
+	const float rayLength = 2.0f * AABB_BENCH_WORLD;
+
+	// Checks
+	CheckQueries(bench, "QueryAABB matches brute force", boxes,
+		[&](uint q, std::vector<void*>& results) { tree.QueryAABB(boxMin[q], boxMax[q], results); },
+		[&](uint q, const BenchBox& box) { return BoxOverlaps(box, boxMin[q], boxMax[q]); });
+
+	CheckQueries(bench, "QuerySphere matches brute force", boxes,
+		[&](uint q, std::vector<void*>& results) { tree.QuerySphere(sphereCenters[q], AABB_BENCH_QUERY_SIZE, results); },
+		[&](uint q, const BenchBox& box) { return BoxInSphere(box, sphereCenters[q], AABB_BENCH_QUERY_SIZE); });
+
+	CheckQueries(bench, "QueryFrustum matches brute force", boxes,
+		[&](uint q, std::vector<void*>& results) { float planes[6][4]; FrustumPlanes(cameras[q], planes); tree.QueryFrustum(planes, results); },
+		[&](uint q, const BenchBox& box) { float planes[6][4]; FrustumPlanes(cameras[q], planes); return BoxInFrustum(box, planes); });
+
+	CheckQueries(bench, "QueryRay matches brute force", boxes,
+		[&](uint q, std::vector<void*>& results) { tree.QueryRay(rayOrigins[q], rayDirections[q], rayLength, results); },
+		[&](uint q, const BenchBox& box) { return BoxOnRay(box, rayOrigins[q], rayDirections[q], rayLength); });
+
+	// Timings, one query per repeat
+	std::vector<void*> results;
+	results.reserve(count);
+	uint q = 0;
+
+	bench.Run("aabbtree", "build 100k proxies", 5, [&]()
+	{
+		AABBTree built;
+		for (uint i = 0; i < count; ++i)
+		{
+			built.CreateProxy(tightMin[i], tightMax[i], &boxes[i]);
+		}
+		return built.GetHeight();
+	});
+
+	bench.Run("aabbtree", "QueryAABB", AABB_BENCH_QUERIES, [&]()
+	{
+		results.clear();
+		tree.QueryAABB(boxMin[q], boxMax[q], results);
+		q = (q + 1) % AABB_BENCH_QUERIES;
+		return results.size();
+	});
+
+	bench.Run("aabbtree", "brute force AABB", AABB_BENCH_QUERIES, [&]()
+	{
+		results.clear();
+		for (uint i = 0; i < count; ++i)
+		{
+			if (BoxOverlaps(boxes[i], boxMin[q], boxMax[q]))
+			{
+				results.push_back(&boxes[i]);
+			}
+		}
+		q = (q + 1) % AABB_BENCH_QUERIES;
+		return results.size();
+	});
+
+	bench.Run("aabbtree", "QuerySphere", AABB_BENCH_QUERIES, [&]()
+	{
+		results.clear();
+		tree.QuerySphere(sphereCenters[q], AABB_BENCH_QUERY_SIZE, results);
+		q = (q + 1) % AABB_BENCH_QUERIES;
+		return results.size();
+	});
+
+	bench.Run("aabbtree", "brute force sphere", AABB_BENCH_QUERIES, [&]()
+	{
+		results.clear();
+		for (uint i = 0; i < count; ++i)
+		{
+			if (BoxInSphere(boxes[i], sphereCenters[q], AABB_BENCH_QUERY_SIZE))
+			{
+				results.push_back(&boxes[i]);
+			}
+		}
+		q = (q + 1) % AABB_BENCH_QUERIES;
+		return results.size();
+	});
+
+	bench.Run("aabbtree", "QueryFrustum", AABB_BENCH_QUERIES, [&]()
+	{
+		float planes[6][4];
+		FrustumPlanes(cameras[q], planes);
+
+		results.clear();
+		tree.QueryFrustum(planes, results);
+		q = (q + 1) % AABB_BENCH_QUERIES;
+		return results.size();
+	});
+
+	bench.Run("aabbtree", "brute force frustum", AABB_BENCH_QUERIES, [&]()
+	{
+		float planes[6][4];
+		FrustumPlanes(cameras[q], planes);
+
+		results.clear();
+		for (uint i = 0; i < count; ++i)
+		{
+			if (BoxInFrustum(boxes[i], planes))
+			{
+				results.push_back(&boxes[i]);
+			}
+		}
+		q = (q + 1) % AABB_BENCH_QUERIES;
+		return results.size();
+	});
+
+	bench.Run("aabbtree", "QueryRay", AABB_BENCH_QUERIES, [&]()
+	{
+		results.clear();
+		tree.QueryRay(rayOrigins[q], rayDirections[q], rayLength, results);
+		q = (q + 1) % AABB_BENCH_QUERIES;
+		return results.size();
+	});
+
+	bench.Run("aabbtree", "brute force ray", AABB_BENCH_QUERIES, [&]()
+	{
+		results.clear();
+		for (uint i = 0; i < count; ++i)
+		{
+			if (BoxOnRay(boxes[i], rayOrigins[q], rayDirections[q], rayLength))
+			{
+				results.push_back(&boxes[i]);
+			}
+		}
+		q = (q + 1) % AABB_BENCH_QUERIES;
+		return results.size();
+	});
+}
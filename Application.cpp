@@ -1,21 +1,28 @@
 #include "Application.h"
 #include "parson\parson.h"
 #include "Brofiler-1.1.2\Brofiler.h"
+#include "MicroBenchmark.h"
+#include <stdlib.h>
+#include <string.h>
 
-Application::Application()
+Application::Application(int argc, char** argv) : scheduler(this)
 {
-	window = new ModuleWindow(this);
+	ParseCommandLine(argc, argv);
+
+	// Headless runs have no window, GL context or audio device:
+	// those modules are still created but stay disabled
+	window = new ModuleWindow(this, !headless);
 	input = new ModuleInput(this);
-	audio = new ModuleAudio(this, true);
-	renderer3D = new ModuleRenderer3D(this);
+	audio = new ModuleAudio(this, !headless);
+	renderer3D = new ModuleRenderer3D(this, !headless);
 	camera = new ModuleCamera3D(this);
 	physics = new ModulePhysics3D(this);
-	imGui = new ModuleImGui(this);
+	imGui = new ModuleImGui(this, !headless);
 	sceneEditor = new ModuleSceneEditor(this);
 
-	// The order of calls is very important!
-	// Modules will Init() Start() and Update in this order
-	// They will CleanUp() in reverse order
+	// Modules will Init() and Start() in this order and CleanUp() in reverse order
+	// Updates follow the dependencies each module declares, running independent
+	// modules in parallel. This order only breaks ties between conflicting writers
 
 	// Main Modules
 	AddModule(window);
@@ -28,16 +35,18 @@ Application::Application()
 
 	// Renderer last!
 	AddModule(renderer3D);
+
+	for (uint i = 0; i < list_modules.Count(); ++i)
+	{
+		list_modules[i]->DeclareDependencies();
+	}
 }
 
 Application::~Application()
 {
-	p2List_item<Module*>* item = list_modules.getLast();
-
-	while(item != NULL)
+	for (int i = list_modules.Count() - 1; i >= 0; --i)
 	{
-		delete item->data;
-		item = item->prev;
+		delete list_modules[i];
 	}
 }
 
@@ -48,27 +57,114 @@ bool Application::Init()
 	BROFILER_CATEGORY("Aplication Init", Profiler::Color::AliceBlue);
 
 	// Call Init() in all modules
-	p2List_item<Module*>* item = list_modules.getFirst();
+	uint i = 0;
 
 	JSON_Value * configValue = json_parse_file("config.json");
 	JSON_Object * configObject = json_value_get_object(configValue);
 
-	while(item != NULL && ret == true)
+	// Started before any module so they can schedule work from Init; 0 threads means one per core
+	jobs.Init((uint)json_object_dotget_number(configObject, "jobs.threads"));
+
+	uint arenaKB = (uint)json_object_dotget_number(configObject, "frameArena.sizeKB");
+	frameArena.Init(arenaKB > 0 ? arenaKB * 1024 : FRAME_ARENA_DEFAULT_SIZE);
+
+	if (json_object_dothas_value(configObject, "memory.frameBudget"))
+	{
+		MemoryTracker::SetFrameBudget((uint)json_object_dotget_number(configObject, "memory.frameBudget"));
+	}
+
+	if (microbenchReport.empty() == false)
+	{
+		LOG("Running microbenchmarks");
+
+		MicroBenchmark bench;
+		RunContainerBenchmarks(bench);
+		RunDynArrayBenchmarks(bench);
+		RunGlmathBenchmarks(bench);
+		RunTransformBenchmarks(bench, jobs);
+		RunAABBTreeBenchmarks(bench);
+		bench.Log();
+
+		if (bench.GetFailedChecks() > 0)
+		{
+			LOG("%u microbenchmark checks failed", bench.GetFailedChecks());
+		}
+
+		if (bench.SaveReport(microbenchReport.c_str()) == false)
+		{
+			LOG("Could not write microbenchmark report to %s", microbenchReport.c_str());
+		}
+	}
+
+	for (i = 0; i < list_modules.Count() && ret == true; ++i)
 	{
-		ret = item->data->Init(json_object_dotget_object(configObject, item->data->name.c_str()));
-		item = item->next;
+		if (list_modules[i]->IsEnabled())
+		{
+			MemoryScope scope(list_modules[i]->memoryTag);
+			ret = list_modules[i]->Init(json_object_dotget_object(configObject, list_modules[i]->name.c_str()));
+		}
 	}
 
 	// After all Init calls we call Start() in all modules
 	LOG("Application Start --------------");
-	item = list_modules.getFirst();
+	for (i = 0; i < list_modules.Count() && ret == true; ++i)
+	{
+		BROFILER_CATEGORY("%s Init", list_modules[i]->name.c_str(), Brofiler::Color::AliceBlue);
+
+		if (list_modules[i]->IsEnabled())
+		{
+			MemoryScope scope(list_modules[i]->memoryTag);
+			ret = list_modules[i]->Start();
+		}
+	}
+
+	// Benchmark scene and physics threading overrides from the command line
+	if (ret == true && benchmarkBoxes > 0)
+	{
+		sceneEditor->AddBoxStacks(benchmarkBoxes);
+	}
+	if (benchmarkPhysicsThreads >= 0)
+	{
+		physics->threads = benchmarkPhysicsThreads;
+	}
 
-	while(item != NULL && ret == true)
+	if (ret == true)
 	{
-		BROFILER_CATEGORY("%s Init", item->data->name.c_str(), Brofiler::Color::AliceBlue);
+		ret = scheduler.Build(list_modules);
+	}
+
+	if (ret == true)
+	{
+		scheduler.LogSchedule();
+
+		if (scheduleExport.empty() == false && scheduler.SaveSchedule(scheduleExport.c_str()) == false)
+		{
+			LOG("Could not write module schedule to %s", scheduleExport.c_str());
+		}
+	}
+
+	if (headless)
+	{
+		LOG("Running headless benchmark: %u frames, dt %f", benchmarkFrames, benchmarkDt);
+		LOG("Physics narrowphase threads: %i, job threads: %u", physics->threads, jobs.GetThreadCount());
 
-		ret = item->data->Start();
-		item = item->next;
+		for (i = 0; i < list_modules.Count(); ++i)
+		{
+			if (list_modules[i]->IsEnabled())
+			{
+				benchmark.AddModule(list_modules[i]->name.c_str());
+			}
+		}
+		benchmark.Reserve(benchmarkFrames);
+	}
+	else if (VSYNC)
+	{
+		// Needed to tell apart frames that missed their vsync slot
+		SDL_DisplayMode dm;
+		if (SDL_GetDesktopDisplayMode(0, &dm) == 0)
+		{
+			pacing.refreshRate = dm.refresh_rate;
+		}
 	}
 	
 	ms_timer.Start();
@@ -78,16 +174,60 @@ bool Application::Init()
 // ---------------------------------------------
 void Application::PrepareUpdate()
 {
+	// dt is the full duration of the previous frame
+	dt = ms_timer.ReadSec();
 	ms_timer.Start();
-	dt = (float)ms_timer.Read() / 1000.0f;
+
+	// Whatever the frame before last allocated is released here
+	frameArena.NextFrame();
+	MemoryTracker::NextFrame();
+
+	if (headless)
+	{
+		dt = benchmarkDt;
+	}
 }
 
 // ---------------------------------------------
 void Application::FinishUpdate()
 {
-	dt = (float)ms_timer.Read() / 1000.0f - dt;
-	lastFPS = 1.0f / dt;
-	lastMs = (float) ms_timer.Read();
+	lastMs = (float)ms_timer.ReadMs();
+	lastFPS = lastMs > 0.0f ? 1000.0f / lastMs : 0.0f;
+
+	AddPacingSample(lastMs);
+}
+
+// ---------------------------------------------
+void Application::AddPacingSample(float ms)
+{
+	if (pacingCount == FRAME_PACING_WINDOW)
+	{
+		float oldest = pacingSamples[pacingIndex];
+		pacingSum -= oldest;
+		pacingSumSquared -= (double)oldest * oldest;
+	}
+	else
+	{
+		++pacingCount;
+	}
+
+	pacingSamples[pacingIndex] = ms;
+	pacingIndex = (pacingIndex + 1) % FRAME_PACING_WINDOW;
+	pacingSum += ms;
+	pacingSumSquared += (double)ms * ms;
+
+	double mean = pacingSum / pacingCount;
+	double variance = pacingSumSquared / pacingCount - mean * mean;
+
+	pacing.frameMs = ms;
+	pacing.meanMs = (float)mean;
+	pacing.variance = variance > 0.0 ? (float)variance : 0.0f;
+
+	// A frame taking over one and a half refresh intervals skipped at least one vsync
+	if (pacing.refreshRate > 0 && ms > 1500.0f / pacing.refreshRate)
+	{
+		++pacing.missedVsyncs;
+	}
 }
 
 // Call PreUpdate, Update and PostUpdate on all modules
@@ -95,56 +235,115 @@ update_status Application::Update()
 {
 	update_status ret = UPDATE_CONTINUE;
 	PrepareUpdate();
-	
-	p2List_item<Module*>* item = list_modules.getFirst();
-	
-	while(item != NULL && ret == UPDATE_CONTINUE)
+
+	ret = UpdateStage(STAGE_PREUPDATE);
+
+	if (ret == UPDATE_CONTINUE)
+	{
+		ret = UpdateStage(STAGE_UPDATE);
+	}
+
+	if (ret == UPDATE_CONTINUE)
 	{
-		ret = item->data->PreUpdate(dt);
-		item = item->next;
+		ret = UpdateStage(STAGE_POSTUPDATE);
 	}
 
-	item = list_modules.getFirst();
+	FinishUpdate();
 
-	while(item != NULL && ret == UPDATE_CONTINUE)
+	if (headless)
 	{
-		ret = item->data->Update(dt);
-		item = item->next;
+		benchmark.AddFrameSample(lastMs);
+
+		if (++benchmarkFrame >= benchmarkFrames && ret == UPDATE_CONTINUE)
+		{
+			ret = UPDATE_STOP;
+		}
 	}
 
-	item = list_modules.getFirst();
+	return ret;
+}
+
+// ---------------------------------------------
+update_status Application::UpdateStage(update_stage stage)
+{
+	return scheduler.Run(stage);
+}
+
+// ---------------------------------------------
+// Called by the scheduler, possibly from a job worker thread
+update_status Application::UpdateModule(Module* module, uint benchmarkIndex, update_stage stage)
+{
+	update_status ret = UPDATE_CONTINUE;
+	Timer stageTimer;
+	MemoryScope scope(module->memoryTag);
 
-	while(item != NULL && ret == UPDATE_CONTINUE)
+	switch (stage)
 	{
-		ret = item->data->PostUpdate(dt);
-		item = item->next;
+	case STAGE_PREUPDATE:
+		ret = module->PreUpdate(dt);
+		break;
+	case STAGE_UPDATE:
+		ret = module->Update(dt);
+		break;
+	case STAGE_POSTUPDATE:
+		ret = module->PostUpdate(dt);
+		break;
+	}
+
+	if (headless)
+	{
+		benchmark.AddSample(benchmarkIndex, stage, stageTimer.ReadMs());
 	}
 
-	FinishUpdate();
 	return ret;
 }
 
 bool Application::CleanUp()
 {
 	bool ret = true;
-	p2List_item<Module*>* item = list_modules.getLast();
+
+	// Before modules release anything, so it shows what the run ended with
+	if (memoryReport.empty() == false && MemoryTracker::SaveReport(memoryReport.c_str()) == false)
+	{
+		LOG("Could not write memory report to %s", memoryReport.c_str());
+	}
 
 	JSON_Value* configValue = json_parse_file("config.json");
 	JSON_Object* objectData = json_value_get_object(configValue);
 
-	while (item != NULL && ret == true)
+	for (int i = list_modules.Count() - 1; i >= 0 && ret == true; --i)
 	{
-		ret = item->data->CleanUp(objectData);
-		item = item->prev;
+		if (list_modules[i]->IsEnabled())
+		{
+			MemoryScope scope(list_modules[i]->memoryTag);
+			ret = list_modules[i]->CleanUp(objectData);
+		}
 	}
-	json_serialize_to_file(configValue, "config.json");
+
+	// Benchmark runs must not overwrite the user configuration
+	if (headless)
+	{
+		if (benchmark.SaveReport(benchmarkReport.c_str(), benchmarkDt) == false)
+		{
+			LOG("Could not write benchmark report to %s", benchmarkReport.c_str());
+			ret = false;
+		}
+	}
+	else
+	{
+		json_serialize_to_file(configValue, "config.json");
+	}
+	json_value_free(configValue);
+
+	jobs.CleanUp();
+	frameArena.CleanUp();
 
 	return ret;
 }
 
 void Application::AddModule(Module* mod)
 {
-	list_modules.add(mod);
+	list_modules.PushBack(mod);
 }
 
 float Application::GetFPS()
@@ -155,4 +354,67 @@ float Application::GetFPS()
 float Application::GetMs()
 {
 	return lastMs;
+}
+
+const FramePacing& Application::GetFramePacing() const
+{
+	return pacing;
+}
+
+bool Application::IsHeadless() const
+{
+	return headless;
+}
+
+// Recognised options:
+// -headless          run without window, renderer, ImGui and audio
+// -frames <count>    number of frames to simulate in headless mode
+// -dt <seconds>      fixed frame delta used in headless mode
+// -report <path>     where the headless timing report is written
+// -schedule <path>   exports the module update schedule as json
+// -stack <boxes>     builds the stacked boxes physics benchmark scene
+// -physicsThreads <n> overrides the physics narrowphase thread count
+// -microbench <path> runs the microbenchmark suites at startup and saves them
+// -memreport <path>  saves the per-subsystem memory report on exit
+void Application::ParseCommandLine(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-headless") == 0)
+		{
+			headless = true;
+		}
+		else if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+		{
+			benchmarkFrames = (uint)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-dt") == 0 && i + 1 < argc)
+		{
+			benchmarkDt = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-report") == 0 && i + 1 < argc)
+		{
+			benchmarkReport = argv[++i];
+		}
+		else if (strcmp(argv[i], "-schedule") == 0 && i + 1 < argc)
+		{
+			scheduleExport = argv[++i];
+		}
+		else if (strcmp(argv[i], "-microbench") == 0 && i + 1 < argc)
+		{
+			microbenchReport = argv[++i];
+		}
+		else if (strcmp(argv[i], "-stack") == 0 && i + 1 < argc)
+		{
+			benchmarkBoxes = (uint)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-physicsThreads") == 0 && i + 1 < argc)
+		{
+			benchmarkPhysicsThreads = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-memreport") == 0 && i + 1 < argc)
+		{
+			memoryReport = argv[++i];
+		}
+	}
 }
\ No newline at end of file
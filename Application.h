@@ -1,6 +1,6 @@
 #pragma once
 
-#include "p2List.h"
+#include "p2SmallArray.h"
 #include "Globals.h"
 #include "Timer.h"
 #include "Module.h"
@@ -12,9 +12,27 @@
 #include "ModulePhysics3D.h"
 #include "ModuleImGui.h"
 #include "ModuleSceneEditor.h"
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "FrameArena.h"
+#include "ModuleScheduler.h"
+
+#define FRAME_PACING_WINDOW 120
+
+// Frame timing statistics over the last FRAME_PACING_WINDOW frames
+struct FramePacing
+{
+	float frameMs = 0.0f;
+	float meanMs = 0.0f;
+	float variance = 0.0f;
+	uint missedVsyncs = 0;
+	int refreshRate = 0;
+};
 
 class Application
 {
+	friend class ModuleScheduler;
+
 public:
 	ModuleWindow* window;
 	ModuleInput* input;
@@ -25,6 +43,10 @@ public:
 	ModuleImGui* imGui;
 	ModuleSceneEditor* sceneEditor;
 
+	JobSystem jobs;
+	// Scratch memory for the current frame, see FrameArena.h
+	FrameArena frameArena;
+
 
 private:
 
@@ -32,11 +54,32 @@ private:
 	float	dt;
 	float lastFPS = 0;
 	float lastMs = 0;
-	p2List<Module*> list_modules;
+	p2SmallArray<Module*> list_modules;
+	ModuleScheduler scheduler;
+	std::string scheduleExport;
+
+	FramePacing pacing;
+	float pacingSamples[FRAME_PACING_WINDOW];
+	uint pacingIndex = 0;
+	uint pacingCount = 0;
+	double pacingSum = 0.0;
+	double pacingSumSquared = 0.0;
+
+	// Headless benchmark mode
+	bool headless = false;
+	uint benchmarkFrames = BENCHMARK_FRAMES;
+	uint benchmarkFrame = 0;
+	float benchmarkDt = BENCHMARK_DT;
+	std::string benchmarkReport = BENCHMARK_REPORT;
+	Benchmark benchmark;
+	std::string microbenchReport;
+	std::string memoryReport;
+	uint benchmarkBoxes = 0;
+	int benchmarkPhysicsThreads = -1;
 
 public:
 
-	Application();
+	Application(int argc = 0, char** argv = nullptr);
 	~Application();
 
 	bool Init();
@@ -45,10 +88,16 @@ public:
 
 	float GetFPS();
 	float GetMs();
+	const FramePacing& GetFramePacing() const;
+	bool IsHeadless() const;
 
 private:
 
+	void ParseCommandLine(int argc, char** argv);
 	void AddModule(Module* mod);
 	void PrepareUpdate();
+	update_status UpdateStage(update_stage stage);
+	update_status UpdateModule(Module* module, uint benchmarkIndex, update_stage stage);
 	void FinishUpdate();
+	void AddPacingSample(float ms);
 };
\ No newline at end of file
@@ -0,0 +1,428 @@
+// ----------------------------------------------------
+// BatchRenderer.cpp
+// Instanced drawing of primitives sharing a mesh
+// ----------------------------------------------------
+
+#include "BatchRenderer.h"
+#include "Primitive.h"
+#include "MeshCache.h"
+#include "Glew\include\glew.h"
+#include <string.h>
+
+#define ATTRIB_POSITION 0
+#define ATTRIB_NORMAL 1
+#define ATTRIB_COLOR 2
+#define ATTRIB_TRANSFORM 3
+
+// Same lighting the fixed pipeline gives the scene: global ambient plus light 0 diffuse
+static const char* vertexSource =
+	"#version 120\n"
+	"attribute vec3 position;\n"
+	"attribute vec3 normal;\n"
+	"attribute vec4 instanceColor;\n"
+	"attribute mat4 instanceTransform;\n"
+	"uniform int lighting;\n"
+	"varying vec4 color;\n"
+	"void main()\n"
+	"{\n"
+	"	vec4 eyePosition = gl_ModelViewMatrix * (instanceTransform * vec4(position, 1.0));\n"
+	"	gl_Position = gl_ProjectionMatrix * eyePosition;\n"
+	"	color = instanceColor;\n"
+	"	if (lighting != 0)\n"
+	"	{\n"
+	"		mat3 rotation = mat3(instanceTransform[0].xyz, instanceTransform[1].xyz, instanceTransform[2].xyz);\n"
+	"		vec3 eyeNormal = normalize(gl_NormalMatrix * (rotation * normal));\n"
+	"		vec3 toLight = normalize(gl_LightSource[0].position.xyz - eyePosition.xyz);\n"
+	"		float diffuse = max(dot(eyeNormal, toLight), 0.0);\n"
+	"		color.rgb *= gl_LightModel.ambient.rgb + gl_LightSource[0].diffuse.rgb * diffuse;\n"
+	"	}\n"
+	"}\n";
+
+static const char* fragmentSource =
+	"#version 120\n"
+	"varying vec4 color;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_FragColor = color;\n"
+	"}\n";
+
+static uint CompileShader(GLenum type, const char* source)
+{
+	uint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, nullptr);
+	glCompileShader(shader);
+
+	int success = 0;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+	if (success == 0)
+	{
+		char info[512];
+		glGetShaderInfoLog(shader, sizeof(info), nullptr, info);
+		LOG("Batch shader compilation failed: %s", info);
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
+// ---------------------------------------------
+BatchRenderer::BatchRenderer()
+{}
+
+// ---------------------------------------------
+BatchRenderer::~BatchRenderer()
+{}
+
+// ---------------------------------------------
+void BatchRenderer::SetFrustum(const float frustumPlanes[6][4])
+{
+	memcpy(planes, frustumPlanes, sizeof(planes));
+	hasFrustum = true;
+}
+
+// ---------------------------------------------
+void BatchRenderer::Submit(const Primitive& primitive)
+{
+	if (IsCulled(primitive.GetBoundsMin(), primitive.GetBoundsMax()))
+	{
+		current.culled++;
+		return;
+	}
+	current.visible++;
+
+	const PrimitiveMesh* mesh = primitive.GetMesh();
+
+	if (mesh == nullptr || primitive.axis)
+	{
+		unbatched.push_back(&primitive);
+		return;
+	}
+
+	AddInstance(mesh, primitive.transform, primitive.GetMeshScale(), primitive.color, primitive.wire);
+}
+
+// ---------------------------------------------
+void BatchRenderer::Submit(const PrimitiveMesh* mesh, const mat4x4& transform, float scale, const Color& color, bool wire, const vec3& boundsMin, const vec3& boundsMax)
+{
+	if (IsCulled(boundsMin, boundsMax))
+	{
+		current.culled++;
+		return;
+	}
+	current.visible++;
+
+	AddInstance(mesh, transform, scale, color, wire);
+}
+
+// ---------------------------------------------
+void BatchRenderer::AddInstance(const PrimitiveMesh* mesh, const mat4x4& transform, float scale, const Color& color, bool wire)
+{
+	Batch* batch = nullptr;
+	for (uint i = 0; i < batches.size(); ++i)
+	{
+		if (batches[i].mesh == mesh && batches[i].wire == wire)
+		{
+			batch = &batches[i];
+			break;
+		}
+	}
+
+	if (batch == nullptr)
+	{
+		batches.push_back(Batch());
+		batch = &batches.back();
+		batch->mesh = mesh;
+		batch->wire = wire;
+	}
+
+	Instance instance;
+	memcpy(instance.transform, transform.M, sizeof(instance.transform));
+
+	if (scale != 1.0f)
+	{
+		for (uint i = 0; i < 12; ++i)
+		{
+			instance.transform[i] *= scale;
+		}
+	}
+
+	instance.color[0] = color.r;
+	instance.color[1] = color.g;
+	instance.color[2] = color.b;
+	instance.color[3] = color.a;
+	batch->instances.push_back(instance);
+}
+
+// ---------------------------------------------
+void BatchRenderer::AddCulled(uint count)
+{
+	current.culled += count;
+}
+
+// ---------------------------------------------
+void BatchRenderer::Flush(bool lighting)
+{
+	if (initialized == false)
+	{
+		initialized = true;
+		instanced = Init();
+	}
+
+	if (instanced)
+	{
+		DrawInstanced(lighting);
+	}
+	else
+	{
+		DrawFallback();
+	}
+
+	// Primitives with their own geometry or an axis gizmo
+	for (uint i = 0; i < unbatched.size(); ++i)
+	{
+		unbatched[i]->Render();
+		current.drawCalls++;
+		current.stateChanges += 3;
+	}
+	unbatched.clear();
+
+	// Keep the batches and their capacity, the scene rarely changes shape
+	for (uint i = 0; i < batches.size(); ++i)
+	{
+		batches[i].instances.clear();
+	}
+
+	stats = current;
+	current = RenderStats();
+}
+
+// ---------------------------------------------
+void BatchRenderer::CleanUp()
+{
+	if (program != 0)
+	{
+		glDeleteProgram(program);
+		program = 0;
+	}
+	if (instanceBuffer != 0)
+	{
+		glDeleteBuffers(1, &instanceBuffer);
+		instanceBuffer = 0;
+	}
+
+	batches.clear();
+	unbatched.clear();
+	initialized = false;
+	instanced = false;
+}
+
+// ---------------------------------------------
+const RenderStats& BatchRenderer::GetStats() const
+{
+	return stats;
+}
+
+// ---------------------------------------------
+bool BatchRenderer::IsInstanced() const
+{
+	return instanced;
+}
+
+// ---------------------------------------------
+bool BatchRenderer::Init()
+{
+	if (!GLEW_VERSION_3_3)
+	{
+		LOG("OpenGL 3.3 not available, primitives will be drawn one by one");
+		return false;
+	}
+
+	uint vertexShader = CompileShader(GL_VERTEX_SHADER, vertexSource);
+	uint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+	if (vertexShader == 0 || fragmentShader == 0)
+	{
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		return false;
+	}
+
+	program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+	glBindAttribLocation(program, ATTRIB_POSITION, "position");
+	glBindAttribLocation(program, ATTRIB_NORMAL, "normal");
+	glBindAttribLocation(program, ATTRIB_COLOR, "instanceColor");
+	glBindAttribLocation(program, ATTRIB_TRANSFORM, "instanceTransform");
+	glLinkProgram(program);
+
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	int success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (success == 0)
+	{
+		char info[512];
+		glGetProgramInfoLog(program, sizeof(info), nullptr, info);
+		LOG("Batch shader link failed: %s", info);
+		glDeleteProgram(program);
+		program = 0;
+		return false;
+	}
+
+	lightingLocation = glGetUniformLocation(program, "lighting");
+	glGenBuffers(1, &instanceBuffer);
+
+	return true;
+}
+
+// ---------------------------------------------
+// Outside as soon as the box corner nearest to a plane's inside is in front of it
+bool BatchRenderer::IsCulled(const vec3& min, const vec3& max) const
+{
+	if (hasFrustum == false)
+	{
+		return false;
+	}
+
+	for (uint i = 0; i < 6; ++i)
+	{
+		const float* plane = planes[i];
+		float x = plane[0] > 0.0f ? min.x : max.x;
+		float y = plane[1] > 0.0f ? min.y : max.y;
+		float z = plane[2] > 0.0f ? min.z : max.z;
+
+		if (plane[0] * x + plane[1] * y + plane[2] * z - plane[3] > 0.0f)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// ---------------------------------------------
+void BatchRenderer::DrawInstanced(bool lighting)
+{
+	// Every batch goes into one upload, each draw points at its own range
+	upload.clear();
+	for (uint i = 0; i < batches.size(); ++i)
+	{
+		upload.insert(upload.end(), batches[i].instances.begin(), batches[i].instances.end());
+	}
+
+	if (upload.empty())
+	{
+		return;
+	}
+
+	glUseProgram(program);
+	glUniform1i(lightingLocation, lighting ? 1 : 0);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, upload.size() * sizeof(Instance), upload.data(), GL_STREAM_DRAW);
+	current.stateChanges += 2;
+
+	glEnableVertexAttribArray(ATTRIB_POSITION);
+	glEnableVertexAttribArray(ATTRIB_NORMAL);
+	glEnableVertexAttribArray(ATTRIB_COLOR);
+	glVertexAttribDivisor(ATTRIB_COLOR, 1);
+	for (uint column = 0; column < 4; ++column)
+	{
+		glEnableVertexAttribArray(ATTRIB_TRANSFORM + column);
+		glVertexAttribDivisor(ATTRIB_TRANSFORM + column, 1);
+	}
+
+	bool wire = false;
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+	uint first = 0;
+	for (uint i = 0; i < batches.size(); ++i)
+	{
+		const Batch& batch = batches[i];
+		if (batch.instances.empty())
+		{
+			continue;
+		}
+
+		if (batch.wire != wire)
+		{
+			wire = batch.wire;
+			glPolygonMode(GL_FRONT_AND_BACK, wire ? GL_LINE : GL_FILL);
+			current.stateChanges++;
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, batch.mesh->vertexBuffer);
+		glVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+		glVertexAttribPointer(ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+
+		uint offset = first * sizeof(Instance);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+		glVertexAttribPointer(ATTRIB_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offset + 16 * sizeof(float)));
+		for (uint column = 0; column < 4; ++column)
+		{
+			glVertexAttribPointer(ATTRIB_TRANSFORM + column, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offset + column * 4 * sizeof(float)));
+		}
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.mesh->indexBuffer);
+		current.stateChanges++;
+
+		glDrawElementsInstanced(GL_TRIANGLES, batch.mesh->indexCount, GL_UNSIGNED_INT, (void*)0, batch.instances.size());
+		current.drawCalls++;
+		current.batches++;
+		current.instances += batch.instances.size();
+
+		first += batch.instances.size();
+	}
+
+	glVertexAttribDivisor(ATTRIB_COLOR, 0);
+	for (uint column = 0; column < 4; ++column)
+	{
+		glVertexAttribDivisor(ATTRIB_TRANSFORM + column, 0);
+		glDisableVertexAttribArray(ATTRIB_TRANSFORM + column);
+	}
+	glDisableVertexAttribArray(ATTRIB_COLOR);
+	glDisableVertexAttribArray(ATTRIB_NORMAL);
+	glDisableVertexAttribArray(ATTRIB_POSITION);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	glUseProgram(0);
+}
+
+// ---------------------------------------------
+// Still skips rebuilding geometry, but pays a matrix and color change per primitive
+void BatchRenderer::DrawFallback()
+{
+	for (uint i = 0; i < batches.size(); ++i)
+	{
+		const Batch& batch = batches[i];
+		if (batch.instances.empty())
+		{
+			continue;
+		}
+
+		glPolygonMode(GL_FRONT_AND_BACK, batch.wire ? GL_LINE : GL_FILL);
+		current.stateChanges++;
+		current.batches++;
+
+		for (uint j = 0; j < batch.instances.size(); ++j)
+		{
+			const Instance& instance = batch.instances[j];
+
+			glPushMatrix();
+			glMultMatrixf(instance.transform);
+			glColor3f(instance.color[0], instance.color[1], instance.color[2]);
+			batch.mesh->Draw();
+			glPopMatrix();
+
+			current.stateChanges += 3;
+			current.drawCalls++;
+			current.instances++;
+		}
+	}
+
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+}
@@ -0,0 +1,92 @@
+#ifndef __BATCHRENDERER_H__
+#define __BATCHRENDERER_H__
+
+#include "Globals.h"
+#include "glmath.h"
+#include "Color.h"
+#include <vector>
+
+class Primitive;
+struct PrimitiveMesh;
+
+// Counted per Flush, state changes are program, buffer, polygon mode
+// and matrix/color changes issued while drawing
+struct RenderStats
+{
+	uint drawCalls = 0;
+	uint stateChanges = 0;
+	uint batches = 0;
+	uint instances = 0;
+	uint visible = 0;
+	uint culled = 0;
+};
+
+// ----------------------------------------------------
+// Groups submitted primitives by mesh and polygon mode
+// and draws each group with one instanced call, falling
+// back to a draw per primitive without GL 3.3
+// ----------------------------------------------------
+class BatchRenderer
+{
+public:
+
+	BatchRenderer();
+	~BatchRenderer();
+
+	// Submitted primitives outside this frustum are dropped
+	void SetFrustum(const float frustumPlanes[6][4]);
+
+	void Submit(const Primitive& primitive);
+	void Submit(const PrimitiveMesh* mesh, const mat4x4& transform, float scale, const Color& color, bool wire, const vec3& boundsMin, const vec3& boundsMax);
+	// For objects a spatial query already rejected
+	void AddCulled(uint count);
+	void Flush(bool lighting);
+
+	// Needs the GL context still alive
+	void CleanUp();
+
+	const RenderStats& GetStats() const;
+	bool IsInstanced() const;
+
+private:
+
+	struct Instance
+	{
+		float transform[16];
+		float color[4];
+	};
+
+	struct Batch
+	{
+		const PrimitiveMesh* mesh;
+		bool wire;
+		std::vector<Instance> instances;
+	};
+
+	bool Init();
+	bool IsCulled(const vec3& min, const vec3& max) const;
+	void AddInstance(const PrimitiveMesh* mesh, const mat4x4& transform, float scale, const Color& color, bool wire);
+	void DrawInstanced(bool lighting);
+	void DrawFallback();
+
+private:
+
+	std::vector<Batch> batches;
+	std::vector<const Primitive*> unbatched;
+	std::vector<Instance> upload;
+
+	// Outward normal and distance of near, far, left, right, top, bottom
+	float planes[6][4];
+	bool hasFrustum = false;
+
+	RenderStats current;
+	RenderStats stats;
+
+	bool initialized = false;
+	bool instanced = false;
+	uint program = 0;
+	uint instanceBuffer = 0;
+	int lightingLocation = -1;
+};
+
+#endif // __BATCHRENDERER_H__
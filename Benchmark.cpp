@@ -0,0 +1,117 @@
+// ----------------------------------------------------
+// Benchmark.cpp
+// Per-module timing histograms for headless runs
+// ----------------------------------------------------
+
+#include "Benchmark.h"
+#include "parson\parson.h"
+#include <algorithm>
+
+static const char* stageNames[STAGE_COUNT] = { "PreUpdate", "Update", "PostUpdate" };
+
+// Sorts a copy of the samples and stores p50/p95/p99/max/mean in a new json object
+static JSON_Value* BuildHistogram(const std::vector<float>& samples)
+{
+	JSON_Value* value = json_value_init_object();
+	JSON_Object* object = json_value_get_object(value);
+
+	std::vector<float> sorted(samples);
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0.0;
+	for (uint i = 0; i < sorted.size(); ++i)
+	{
+		total += sorted[i];
+	}
+
+	uint count = sorted.size();
+	json_object_set_number(object, "samples", count);
+	json_object_set_number(object, "mean", count > 0 ? total / count : 0.0);
+	json_object_set_number(object, "p50", count > 0 ? sorted[(count - 1) * 50 / 100] : 0.0);
+	json_object_set_number(object, "p95", count > 0 ? sorted[(count - 1) * 95 / 100] : 0.0);
+	json_object_set_number(object, "p99", count > 0 ? sorted[(count - 1) * 99 / 100] : 0.0);
+	json_object_set_number(object, "max", count > 0 ? sorted[count - 1] : 0.0);
+
+	return value;
+}
+
+// ---------------------------------------------
+Benchmark::Benchmark()
+{}
+
+// ---------------------------------------------
+Benchmark::~Benchmark()
+{}
+
+// ---------------------------------------------
+void Benchmark::Reserve(uint frameCount)
+{
+	frames.reserve(frameCount);
+
+	for (uint i = 0; i < modules.size(); ++i)
+	{
+		for (uint stage = 0; stage < STAGE_COUNT; ++stage)
+		{
+			modules[i].stages[stage].reserve(frameCount);
+		}
+	}
+}
+
+// ---------------------------------------------
+uint Benchmark::AddModule(const char* name)
+{
+	ModuleSamples samples;
+	samples.name = name;
+	modules.push_back(samples);
+
+	return modules.size() - 1;
+}
+
+// ---------------------------------------------
+void Benchmark::AddSample(uint module, update_stage stage, double ms)
+{
+	if (module < modules.size())
+	{
+		modules[module].stages[stage].push_back((float)ms);
+	}
+}
+
+// ---------------------------------------------
+void Benchmark::AddFrameSample(double ms)
+{
+	frames.push_back((float)ms);
+}
+
+// ---------------------------------------------
+bool Benchmark::SaveReport(const char* path, float dt) const
+{
+	JSON_Value* rootValue = json_value_init_object();
+	JSON_Object* root = json_value_get_object(rootValue);
+
+	json_object_set_number(root, "frames", frames.size());
+	json_object_set_number(root, "dt", dt);
+	json_object_set_value(root, "frame", BuildHistogram(frames));
+
+	JSON_Value* modulesValue = json_value_init_object();
+	JSON_Object* modulesObject = json_value_get_object(modulesValue);
+
+	for (uint i = 0; i < modules.size(); ++i)
+	{
+		JSON_Value* moduleValue = json_value_init_object();
+		JSON_Object* moduleObject = json_value_get_object(moduleValue);
+
+		for (uint stage = 0; stage < STAGE_COUNT; ++stage)
+		{
+			json_object_set_value(moduleObject, stageNames[stage], BuildHistogram(modules[i].stages[stage]));
+		}
+
+		json_object_set_value(modulesObject, modules[i].name.c_str(), moduleValue);
+	}
+
+	json_object_set_value(root, "modules", modulesValue);
+
+	bool ret = json_serialize_to_file_pretty(rootValue, path) == JSONSuccess;
+	json_value_free(rootValue);
+
+	return ret;
+}
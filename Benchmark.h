@@ -0,0 +1,40 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include "Globals.h"
+#include <string>
+#include <vector>
+
+// ----------------------------------------------------
+// Collects per-module frame stage timings while the
+// application runs in headless benchmark mode and
+// writes them as a percentile report
+// ----------------------------------------------------
+class Benchmark
+{
+public:
+
+	Benchmark();
+	~Benchmark();
+
+	void Reserve(uint frames);
+	uint AddModule(const char* name);
+
+	void AddSample(uint module, update_stage stage, double ms);
+	void AddFrameSample(double ms);
+
+	bool SaveReport(const char* path, float dt) const;
+
+private:
+
+	struct ModuleSamples
+	{
+		std::string name;
+		std::vector<float> stages[STAGE_COUNT];
+	};
+
+	std::vector<ModuleSamples> modules;
+	std::vector<float> frames;
+};
+
+#endif // __BENCHMARK_H__
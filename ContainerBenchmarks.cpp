@@ -0,0 +1,101 @@
+// ----------------------------------------------------
+// ContainerBenchmarks.cpp
+// p2List against p2SmallArray on insertion, iteration
+// and lookup of engine sized element counts
+// ----------------------------------------------------
+
+#include "MicroBenchmark.h"
+#include "p2List.h"
+#include "p2SmallArray.h"
+
+#define CONTAINER_BENCH_ELEMENTS 100000
+#define CONTAINER_BENCH_REPEATS 20
+#define CONTAINER_BENCH_LOOKUPS 100
+
+// ---------------------------------------------
+void RunContainerBenchmarks(MicroBenchmark& bench)
+{
+	const uint count = CONTAINER_BENCH_ELEMENTS;
+
+	// Insertion
+	bench.Run("containers", "p2List add", CONTAINER_BENCH_REPEATS, [count]()
+	{
+		p2List<uint> list;
+		for (uint i = 0; i < count; ++i)
+		{
+			list.add(i);
+		}
+		return list.count();
+	});
+
+	bench.Run("containers", "p2SmallArray PushBack", CONTAINER_BENCH_REPEATS, [count]()
+	{
+		p2SmallArray<uint> array;
+		for (uint i = 0; i < count; ++i)
+		{
+			array.PushBack(i);
+		}
+		return array.Count();
+	});
+
+	bench.Run("containers", "p2SmallArray PushBack reserved", CONTAINER_BENCH_REPEATS, [count]()
+	{
+		p2SmallArray<uint> array;
+		array.Reserve(count);
+		for (uint i = 0; i < count; ++i)
+		{
+			array.PushBack(i);
+		}
+		return array.Count();
+	});
+
+	// Iteration
+	p2List<uint> list;
+	p2SmallArray<uint> array;
+	for (uint i = 0; i < count; ++i)
+	{
+		list.add(i);
+		array.PushBack(i);
+	}
+
+	bench.Run("containers", "p2List iterate", CONTAINER_BENCH_REPEATS, [&list]()
+	{
+		uint64 sum = 0;
+		for (p2List_item<uint>* item = list.getFirst(); item != NULL; item = item->next)
+		{
+			sum += item->data;
+		}
+		return sum;
+	});
+
+	bench.Run("containers", "p2SmallArray iterate", CONTAINER_BENCH_REPEATS, [&array]()
+	{
+		uint64 sum = 0;
+		for (uint value : array)
+		{
+			sum += value;
+		}
+		return sum;
+	});
+
+	// Lookup of values spread over the second half
+	bench.Run("containers", "p2List find", CONTAINER_BENCH_REPEATS, [&list, count]()
+	{
+		long long found = 0;
+		for (uint i = 0; i < CONTAINER_BENCH_LOOKUPS; ++i)
+		{
+			found += list.find(count / 2 + i * (count / 2 / CONTAINER_BENCH_LOOKUPS));
+		}
+		return found;
+	});
+
+	bench.Run("containers", "p2SmallArray Find", CONTAINER_BENCH_REPEATS, [&array, count]()
+	{
+		long long found = 0;
+		for (uint i = 0; i < CONTAINER_BENCH_LOOKUPS; ++i)
+		{
+			found += array.Find(count / 2 + i * (count / 2 / CONTAINER_BENCH_LOOKUPS));
+		}
+		return found;
+	});
+}
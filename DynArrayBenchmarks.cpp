@@ -0,0 +1,132 @@
+// ----------------------------------------------------
+// DynArrayBenchmarks.cpp
+// p2DynArray against std::vector with trivial and
+// non trivial element types
+// ----------------------------------------------------
+
+#include "MicroBenchmark.h"
+#include "p2DynArray.h"
+#include <vector>
+#include <string>
+
+#define DYN_ARRAY_BENCH_ELEMENTS 100000
+#define DYN_ARRAY_BENCH_STRINGS 20000
+#define DYN_ARRAY_BENCH_REPEATS 20
+
+// Long enough to skip the small string buffer, so copies allocate
+static std::string MakeString(uint i)
+{
+	return std::string("p2DynArray benchmark element ") + std::to_string(i);
+}
+
+// ---------------------------------------------
+void RunDynArrayBenchmarks(MicroBenchmark& bench)
+{
+	const uint count = DYN_ARRAY_BENCH_ELEMENTS;
+	const uint strings = DYN_ARRAY_BENCH_STRINGS;
+
+	// POD
+	bench.Run("dynarray", "p2DynArray<uint> PushBack", DYN_ARRAY_BENCH_REPEATS, [count]()
+	{
+		p2DynArray<uint> array;
+		for (uint i = 0; i < count; ++i)
+		{
+			array.PushBack(i);
+		}
+		return array.Count();
+	});
+
+	bench.Run("dynarray", "std::vector<uint> push_back", DYN_ARRAY_BENCH_REPEATS, [count]()
+	{
+		std::vector<uint> vector;
+		for (uint i = 0; i < count; ++i)
+		{
+			vector.push_back(i);
+		}
+		return vector.size();
+	});
+
+	p2DynArray<uint> array;
+	std::vector<uint> vector;
+	for (uint i = 0; i < count; ++i)
+	{
+		array.PushBack(i);
+		vector.push_back(i);
+	}
+
+	bench.Run("dynarray", "p2DynArray<uint> iterate", DYN_ARRAY_BENCH_REPEATS, [&array]()
+	{
+		uint64 sum = 0;
+		for (uint value : array)
+		{
+			sum += value;
+		}
+		return sum;
+	});
+
+	bench.Run("dynarray", "std::vector<uint> iterate", DYN_ARRAY_BENCH_REPEATS, [&vector]()
+	{
+		uint64 sum = 0;
+		for (uint value : vector)
+		{
+			sum += value;
+		}
+		return sum;
+	});
+
+	bench.Run("dynarray", "p2DynArray<uint> copy", DYN_ARRAY_BENCH_REPEATS, [&array]()
+	{
+		p2DynArray<uint> copy(array);
+		return copy.Count();
+	});
+
+	bench.Run("dynarray", "std::vector<uint> copy", DYN_ARRAY_BENCH_REPEATS, [&vector]()
+	{
+		std::vector<uint> copy(vector);
+		return copy.size();
+	});
+
+	// Non trivial: growth has to move, not copy, the strings
+	bench.Run("dynarray", "p2DynArray<string> EmplaceBack", DYN_ARRAY_BENCH_REPEATS, [strings]()
+	{
+		p2DynArray<std::string> array;
+		for (uint i = 0; i < strings; ++i)
+		{
+			array.EmplaceBack(MakeString(i));
+		}
+		return array.Count();
+	});
+
+	bench.Run("dynarray", "std::vector<string> emplace_back", DYN_ARRAY_BENCH_REPEATS, [strings]()
+	{
+		std::vector<std::string> vector;
+		for (uint i = 0; i < strings; ++i)
+		{
+			vector.emplace_back(MakeString(i));
+		}
+		return vector.size();
+	});
+
+	bench.Run("dynarray", "p2DynArray<string> move", DYN_ARRAY_BENCH_REPEATS, [strings]()
+	{
+		p2DynArray<std::string> array(strings);
+		for (uint i = 0; i < strings; ++i)
+		{
+			array.PushBack(MakeString(i));
+		}
+		p2DynArray<std::string> moved(std::move(array));
+		return moved.Count();
+	});
+
+	bench.Run("dynarray", "std::vector<string> move", DYN_ARRAY_BENCH_REPEATS, [strings]()
+	{
+		std::vector<std::string> vector;
+		vector.reserve(strings);
+		for (uint i = 0; i < strings; ++i)
+		{
+			vector.push_back(MakeString(i));
+		}
+		std::vector<std::string> moved(std::move(vector));
+		return moved.size();
+	});
+}
@@ -0,0 +1,174 @@
+// ----------------------------------------------------
+// FrameArena.cpp
+// Double buffered bump allocator for per frame data
+// ----------------------------------------------------
+
+#include "FrameArena.h"
+#include "p2Allocator.h"
+#include <stdio.h>
+#include <stdarg.h>
+
+// ---------------------------------------------
+FrameArena::FrameArena()
+{
+	buffers[0].offset = 0;
+	buffers[1].offset = 0;
+}
+
+// ---------------------------------------------
+FrameArena::~FrameArena()
+{
+	CleanUp();
+}
+
+// ---------------------------------------------
+bool FrameArena::Init(uint capacity)
+{
+	CleanUp();
+
+	this->capacity = capacity;
+	stats.capacity = capacity;
+
+	p2SystemAllocator heap;
+	for (uint i = 0; i < 2; ++i)
+	{
+		buffers[i].memory = static_cast<char*>(heap.Allocate(capacity, FRAME_ARENA_ALIGNMENT));
+	}
+
+	LOG("Frame arena: 2 buffers of %u KB", capacity / 1024);
+
+	return true;
+}
+
+// ---------------------------------------------
+void FrameArena::CleanUp()
+{
+	p2SystemAllocator heap;
+	for (uint i = 0; i < 2; ++i)
+	{
+		Reset(buffers[i]);
+		heap.Free(buffers[i].memory, capacity, FRAME_ARENA_ALIGNMENT);
+		buffers[i].memory = nullptr;
+	}
+
+	capacity = 0;
+	stats = FrameArenaStats();
+}
+
+// ---------------------------------------------
+void FrameArena::NextFrame()
+{
+	Buffer& finished = buffers[current];
+
+	stats.used = (uint)(finished.offset.load() + finished.overflowBytes);
+	stats.overflowBytes = (uint)finished.overflowBytes;
+	stats.overflowAllocations = finished.overflow.size();
+
+	if (stats.used > stats.highWater)
+	{
+		stats.highWater = stats.used;
+	}
+
+	if (finished.overflow.empty() == false)
+	{
+		// Only the first one, an undersized arena overflows every frame
+		if (stats.overflowFrames++ == 0)
+		{
+			LOG("Frame arena overflowed by %u bytes, consider raising frameArena.sizeKB", stats.overflowBytes);
+		}
+	}
+
+	current = 1 - current;
+	Reset(buffers[current]);
+}
+
+// ---------------------------------------------
+void* FrameArena::Allocate(size_t bytes, size_t alignment)
+{
+	Buffer& buffer = buffers[current];
+
+	if (buffer.memory != nullptr)
+	{
+		size_t base = (size_t)buffer.memory;
+		size_t offset = buffer.offset.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			size_t start = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+			size_t end = start + bytes;
+
+			if (end > capacity)
+			{
+				break;
+			}
+
+			if (buffer.offset.compare_exchange_weak(offset, end, std::memory_order_relaxed))
+			{
+				return buffer.memory + start;
+			}
+		}
+	}
+
+	// Out of space: heap block kept until this buffer is reset
+	p2SystemAllocator heap;
+	Overflow overflow;
+	overflow.memory = heap.Allocate(bytes, alignment);
+	overflow.bytes = bytes;
+	overflow.alignment = alignment;
+
+	std::lock_guard<std::mutex> lock(overflowMutex);
+	buffer.overflow.push_back(overflow);
+	buffer.overflowBytes += bytes;
+
+	return overflow.memory;
+}
+
+// ---------------------------------------------
+const char* FrameArena::Printf(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	va_list measure;
+	va_copy(measure, args);
+	int length = vsnprintf(nullptr, 0, format, measure);
+	va_end(measure);
+
+	if (length < 0)
+	{
+		va_end(args);
+		return "";
+	}
+
+	char* text = Allocate<char>(length + 1);
+	vsnprintf(text, length + 1, format, args);
+	va_end(args);
+
+	return text;
+}
+
+// ---------------------------------------------
+uint FrameArena::GetUsed() const
+{
+	const Buffer& buffer = buffers[current];
+	return (uint)(buffer.offset.load() + buffer.overflowBytes);
+}
+
+// ---------------------------------------------
+const FrameArenaStats& FrameArena::GetStats() const
+{
+	return stats;
+}
+
+// ---------------------------------------------
+void FrameArena::Reset(Buffer& buffer)
+{
+	p2SystemAllocator heap;
+	for (uint i = 0; i < buffer.overflow.size(); ++i)
+	{
+		heap.Free(buffer.overflow[i].memory, buffer.overflow[i].bytes, buffer.overflow[i].alignment);
+	}
+
+	buffer.overflow.clear();
+	buffer.overflowBytes = 0;
+	buffer.offset = 0;
+}
@@ -0,0 +1,109 @@
+#ifndef __FRAMEARENA_H__
+#define __FRAMEARENA_H__
+
+#include "Globals.h"
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Bytes per buffer when the configuration doesn't say otherwise
+#define FRAME_ARENA_DEFAULT_SIZE (1024 * 1024)
+#define FRAME_ARENA_ALIGNMENT 16
+
+// Sizes in bytes. used and overflow describe the last finished frame
+struct FrameArenaStats
+{
+	uint capacity = 0;
+	uint used = 0;
+	uint highWater = 0;
+	uint overflowBytes = 0;
+	uint overflowAllocations = 0;
+	uint overflowFrames = 0;
+};
+
+// ----------------------------------------------------
+// Linear allocator for data that only lives a frame.
+// Two buffers alternate: NextFrame empties the older one,
+// so anything allocated stays valid through the next frame.
+// Allocations bump an atomic offset and may come from jobs,
+// requests that don't fit fall back to the heap until the
+// buffer is reused. Nothing is destructed on reset
+// ----------------------------------------------------
+class FrameArena
+{
+public:
+
+	FrameArena();
+	~FrameArena();
+
+	bool Init(uint capacity = FRAME_ARENA_DEFAULT_SIZE);
+	void CleanUp();
+
+	// Main thread only, with no job allocating
+	void NextFrame();
+
+	void* Allocate(size_t bytes, size_t alignment = FRAME_ARENA_ALIGNMENT);
+
+	template<class TYPE>
+	TYPE* Allocate(uint count)
+	{
+		return static_cast<TYPE*>(Allocate(count * sizeof(TYPE), alignof(TYPE)));
+	}
+
+	// Formatted copy of a string in the arena
+	const char* Printf(const char* format, ...);
+
+	// Bytes taken from the current buffer so far, overflow included
+	uint GetUsed() const;
+	const FrameArenaStats& GetStats() const;
+
+private:
+
+	struct Overflow
+	{
+		void* memory;
+		size_t bytes;
+		size_t alignment;
+	};
+
+	struct Buffer
+	{
+		char* memory = nullptr;
+		std::atomic<size_t> offset;
+		std::vector<Overflow> overflow;
+		size_t overflowBytes = 0;
+	};
+
+	void Reset(Buffer& buffer);
+
+private:
+
+	Buffer buffers[2];
+	uint current = 0;
+	size_t capacity = 0;
+
+	std::mutex overflowMutex;
+	FrameArenaStats stats;
+};
+
+// p2 container allocator (see p2Allocator.h) drawing from a frame arena.
+// Blocks are released with the frame, so a container using it must be
+// dropped or rebuilt before its arena buffer is reused
+struct p2FrameAllocator
+{
+	p2FrameAllocator(FrameArena* arena = nullptr) : arena(arena)
+	{}
+
+	void* Allocate(size_t bytes, size_t alignment)
+	{
+		return arena->Allocate(bytes, alignment);
+	}
+
+	void Free(void* ptr, size_t bytes, size_t alignment)
+	{}
+
+	FrameArena* arena;
+};
+
+#endif // __FRAMEARENA_H__
@@ -0,0 +1,210 @@
+// ----------------------------------------------------
+// GlmathBenchmarks.cpp
+// SIMD glmath operations against their scalar versions,
+// timed and checked for matching results
+// ----------------------------------------------------
+
+#include "MicroBenchmark.h"
+#include "glmath.h"
+#include <vector>
+#include <string.h>
+
+#define GLMATH_BENCH_ELEMENTS 10000
+#define GLMATH_BENCH_REPEATS 50
+// Inverse sums its terms in a different order, relative to the largest element
+#define GLMATH_INVERSE_TOLERANCE 1e-5
+
+// Scaled, rotated and translated like scene transforms
+static mat4x4 RandomTransform(uint& seed)
+{
+	vec3 axis = RandomVec3(seed, -1.0f, 1.0f);
+	if (length2(axis) < 0.01f)
+	{
+		axis = vec3(0.0f, 1.0f, 0.0f);
+	}
+	vec3 position = RandomVec3(seed, -100.0f, 100.0f);
+	vec3 size = RandomVec3(seed, 0.5f, 2.0f);
+
+	return translate(position.x, position.y, position.z) * rotate(RandomRange(seed, -180.0f, 180.0f), axis) * scale(size.x, size.y, size.z);
+}
+
+static double MaxDifference(const float* a, const float* b, uint count, bool relative)
+{
+	double largest = 1.0;
+	if (relative)
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			largest = fabs(b[i]) > largest ? fabs(b[i]) : largest;
+		}
+	}
+
+	double error = 0.0;
+	for (uint i = 0; i < count; ++i)
+	{
+		double difference = fabs((double)a[i] - b[i]) / largest;
+		error = difference > error ? difference : error;
+	}
+	return error;
+}
+
+// ---------------------------------------------
+// Bitwise for everything computed in the scalar order
+template<class TYPE, class SIMD, class SCALAR>
+static void CheckExact(MicroBenchmark& bench, const char* name, uint count, SIMD simd, SCALAR scalar)
+{
+	bool passed = true;
+	double error = 0.0;
+
+	for (uint i = 0; i < count; ++i)
+	{
+		TYPE a = simd(i);
+		TYPE b = scalar(i);
+
+		if (memcmp(&a, &b, sizeof(TYPE)) != 0)
+		{
+			passed = false;
+			double difference = MaxDifference((const float*)&a, (const float*)&b, sizeof(TYPE) / sizeof(float), false);
+			error = difference > error ? difference : error;
+		}
+	}
+
+	bench.Check("glmath", name, passed, error);
+}
+
+// ---------------------------------------------
+void RunGlmathBenchmarks(MicroBenchmark& bench)
+{
+	const uint count = GLMATH_BENCH_ELEMENTS;
+
+	if (simd_enabled() == false)
+	{
+		LOG("glmath built without SIMD, both paths are scalar");
+	}
+
+	uint seed = 12345u;
+	std::vector<mat4x4> matrices(count);
+	std::vector<mat4x4> others(count);
+	std::vector<vec4> vectors(count);
+	std::vector<vec3> directions(count);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		matrices[i] = RandomTransform(seed);
+		others[i] = RandomTransform(seed);
+		vectors[i] = vec4(RandomVec3(seed, -10.0f, 10.0f), 1.0f);
+		directions[i] = RandomVec3(seed, -10.0f, 10.0f);
+	}
+
+	// Checks
+	CheckExact<mat4x4>(bench, "mat4x4 * mat4x4", count, [&](uint i) { return matrices[i] * others[i]; }, [&](uint i) { return scalar_multiply(matrices[i], others[i]); });
+	CheckExact<vec4>(bench, "mat4x4 * vec4", count, [&](uint i) { return matrices[i] * vectors[i]; }, [&](uint i) { return scalar_multiply(matrices[i], vectors[i]); });
+	CheckExact<mat4x4>(bench, "transpose", count, [&](uint i) { return transpose(matrices[i]); }, [&](uint i) { return scalar_transpose(matrices[i]); });
+	CheckExact<vec3>(bench, "normalize", count, [&](uint i) { return normalize(directions[i]); }, [&](uint i) { return scalar_normalize(directions[i]); });
+
+	double inverseError = 0.0;
+	for (uint i = 0; i < count; ++i)
+	{
+		mat4x4 a = inverse(matrices[i]);
+		mat4x4 b = scalar_inverse(matrices[i]);
+
+		double difference = MaxDifference(&a, &b, 16, true);
+		inverseError = difference > inverseError ? difference : inverseError;
+	}
+	bench.Check("glmath", "inverse", inverseError <= GLMATH_INVERSE_TOLERANCE, inverseError);
+
+	// Timings
+	std::vector<mat4x4> matrixResults(count);
+	std::vector<vec4> vectorResults(count);
+	std::vector<vec3> directionResults(count);
+
+	bench.Run("glmath", "mat4x4 * mat4x4", GLMATH_BENCH_REPEATS, [&]()
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			matrixResults[i] = matrices[i] * others[i];
+		}
+		return matrixResults.size();
+	});
+
+	bench.Run("glmath", "scalar mat4x4 * mat4x4", GLMATH_BENCH_REPEATS, [&]()
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			matrixResults[i] = scalar_multiply(matrices[i], others[i]);
+		}
+		return matrixResults.size();
+	});
+
+	bench.Run("glmath", "mat4x4 * vec4", GLMATH_BENCH_REPEATS, [&]()
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			vectorResults[i] = matrices[i] * vectors[i];
+		}
+		return vectorResults.size();
+	});
+
+	bench.Run("glmath", "scalar mat4x4 * vec4", GLMATH_BENCH_REPEATS, [&]()
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			vectorResults[i] = scalar_multiply(matrices[i], vectors[i]);
+		}
+		return vectorResults.size();
+	});
+
+	bench.Run("glmath", "inverse", GLMATH_BENCH_REPEATS, [&]()
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			matrixResults[i] = inverse(matrices[i]);
+		}
+		return matrixResults.size();
+	});
+
+	bench.Run("glmath", "scalar inverse", GLMATH_BENCH_REPEATS, [&]()
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			matrixResults[i] = scalar_inverse(matrices[i]);
+		}
+		return matrixResults.size();
+	});
+
+	bench.Run("glmath", "transpose", GLMATH_BENCH_REPEATS, [&]()
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			matrixResults[i] = transpose(matrices[i]);
+		}
+		return matrixResults.size();
+	});
+
+	bench.Run("glmath", "scalar transpose", GLMATH_BENCH_REPEATS, [&]()
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			matrixResults[i] = scalar_transpose(matrices[i]);
+		}
+		return matrixResults.size();
+	});
+
+	bench.Run("glmath", "normalize", GLMATH_BENCH_REPEATS, [&]()
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			directionResults[i] = normalize(directions[i]);
+		}
+		return directionResults.size();
+	});
+
+	bench.Run("glmath", "scalar normalize", GLMATH_BENCH_REPEATS, [&]()
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			directionResults[i] = scalar_normalize(directions[i]);
+		}
+		return directionResults.size();
+	});
+}
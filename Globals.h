@@ -19,6 +19,7 @@ void log(const char file[], int line, const char* format, ...);
 
 
 typedef unsigned int uint;
+typedef unsigned long long uint64;
 
 enum update_status
 {
@@ -27,6 +28,14 @@ enum update_status
 	UPDATE_ERROR
 };
 
+enum update_stage
+{
+	STAGE_PREUPDATE = 0,
+	STAGE_UPDATE,
+	STAGE_POSTUPDATE,
+	STAGE_COUNT
+};
+
 // Configuration -----------
 #define SCREEN_WIDTH 1280
 #define SCREEN_HEIGHT 1024
@@ -36,4 +45,12 @@ enum update_status
 #define WIN_BORDERLESS false
 #define WIN_FULLSCREEN_DESKTOP false
 #define VSYNC true
-#define TITLE "3D Game Engine"
\ No newline at end of file
+#define TITLE "3D Game Engine"
+
+// Replaces global new/delete to count allocations per subsystem, see MemoryTracker.h
+#define MEMORY_TRACKING 1
+
+// Headless benchmark defaults -----------
+#define BENCHMARK_FRAMES 1000
+#define BENCHMARK_DT (1.0f / 60.0f)
+#define BENCHMARK_REPORT "benchmark.json"
\ No newline at end of file
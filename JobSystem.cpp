@@ -0,0 +1,350 @@
+// ----------------------------------------------------
+// JobSystem.cpp
+// Work-stealing job scheduler shared by all modules
+// ----------------------------------------------------
+
+#include "JobSystem.h"
+#include "Brofiler-1.1.2\Brofiler.h"
+#include <assert.h>
+
+// Index of the calling thread inside the job system, -1 for foreign threads
+static thread_local int threadIndex = -1;
+
+// JOB QUEUE ============================================
+JobQueue::JobQueue() : top(0), bottom(0)
+{}
+
+// ---------------------------------------------
+void JobQueue::Push(Job* job)
+{
+	long b = bottom.load(std::memory_order_relaxed);
+	assert(b - top.load(std::memory_order_relaxed) < JOB_QUEUE_SIZE && "Job queue overflow");
+	jobs[b & JOB_QUEUE_MASK].store(job, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_release);
+}
+
+// ---------------------------------------------
+Job* JobQueue::Pop()
+{
+	long b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long t = top.load(std::memory_order_relaxed);
+
+	if (t > b)
+	{
+		// Queue was empty
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = jobs[b & JOB_QUEUE_MASK].load(std::memory_order_relaxed);
+
+	if (t == b)
+	{
+		// Last job left, race against thieves for it
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	return job;
+}
+
+// ---------------------------------------------
+Job* JobQueue::Steal()
+{
+	long t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long b = bottom.load(std::memory_order_acquire);
+
+	if (t >= b)
+	{
+		return nullptr;
+	}
+
+	Job* job = jobs[t & JOB_QUEUE_MASK].load(std::memory_order_relaxed);
+
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		// Lost against the owner or another thief
+		return nullptr;
+	}
+
+	return job;
+}
+
+// JOB SYSTEM ============================================
+JobSystem::JobSystem() : queuedJobs(0), sleepingWorkers(0), quit(false)
+{}
+
+// ---------------------------------------------
+JobSystem::~JobSystem()
+{
+	CleanUp();
+}
+
+// ---------------------------------------------
+bool JobSystem::Init(uint threads)
+{
+	if (workers != nullptr)
+	{
+		return true;
+	}
+
+	threadCount = threads;
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	if (threadCount == 0)
+	{
+		threadCount = 1;
+	}
+
+	LOG("Starting job system with %u threads", threadCount);
+
+	quit = false;
+	workers = new Worker[threadCount];
+
+	for (uint i = 0; i < threadCount; ++i)
+	{
+		workers[i].blocked.reserve(JOB_QUEUE_SIZE);
+	}
+
+	// Slot 0 belongs to the thread calling Init, it takes jobs while waiting
+	threadIndex = 0;
+
+	for (uint i = 1; i < threadCount; ++i)
+	{
+		workers[i].thread = std::thread(&JobSystem::WorkerLoop, this, i);
+	}
+
+	return true;
+}
+
+// ---------------------------------------------
+bool JobSystem::CleanUp()
+{
+	if (workers == nullptr)
+	{
+		return true;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		quit = true;
+	}
+	wakeCondition.notify_all();
+
+	for (uint i = 1; i < threadCount; ++i)
+	{
+		workers[i].thread.join();
+	}
+
+	delete[] workers;
+	workers = nullptr;
+	threadCount = 0;
+	threadIndex = -1;
+
+	return true;
+}
+
+// ---------------------------------------------
+void JobSystem::Run(JobFunction function, void* data, JobCounter* counter, const JobCounter* dependency, uint begin, uint end)
+{
+	if (counter != nullptr)
+	{
+		++counter->pending;
+	}
+
+	// Threads outside the job system have no queue of their own
+	if (workers == nullptr || threadIndex < 0)
+	{
+		while (dependency != nullptr && !dependency->IsDone())
+		{
+			std::this_thread::yield();
+		}
+
+		function(data, begin, end);
+
+		if (counter != nullptr)
+		{
+			--counter->pending;
+		}
+		return;
+	}
+
+	Worker& worker = workers[threadIndex];
+
+	// Slots are handed out in order, the next one may still be queued or blocked
+	Job* job = &worker.pool[worker.allocated & JOB_QUEUE_MASK];
+	while (job->busy.load(std::memory_order_acquire))
+	{
+		Job* other = GetJob(threadIndex);
+
+		if (other != nullptr)
+		{
+			Execute(other);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+
+		// A job run above may have scheduled jobs of its own
+		job = &worker.pool[worker.allocated & JOB_QUEUE_MASK];
+	}
+
+	++worker.allocated;
+	job->busy.store(true, std::memory_order_relaxed);
+	job->function = function;
+	job->data = data;
+	job->begin = begin;
+	job->end = end;
+	job->counter = counter;
+	job->dependency = dependency;
+
+	++queuedJobs;
+	worker.queue.Push(job);
+
+	if (sleepingWorkers.load() > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+		}
+		wakeCondition.notify_one();
+	}
+}
+
+// ---------------------------------------------
+void JobSystem::Wait(const JobCounter& counter)
+{
+	while (!counter.IsDone())
+	{
+		Job* job = (workers != nullptr && threadIndex >= 0) ? GetJob(threadIndex) : nullptr;
+
+		if (job != nullptr)
+		{
+			Execute(job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+// ---------------------------------------------
+uint JobSystem::GetThreadCount() const
+{
+	return threadCount;
+}
+
+// ---------------------------------------------
+void JobSystem::WorkerLoop(uint index)
+{
+	BROFILER_THREAD("Job Worker");
+
+	threadIndex = index;
+
+	while (!quit)
+	{
+		Job* job = GetJob(index);
+
+		if (job != nullptr)
+		{
+			Execute(job);
+		}
+		else if (queuedJobs.load() > 0)
+		{
+			// Work exists but is blocked on a dependency or being raced for
+			std::this_thread::yield();
+		}
+		else
+		{
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			++sleepingWorkers;
+			wakeCondition.wait(lock, [this] { return quit || queuedJobs.load() > 0; });
+			--sleepingWorkers;
+		}
+	}
+}
+
+// ---------------------------------------------
+// Jobs waiting on a dependency are parked instead of pushed back: Pop would
+// hand the same job out again and, with a single thread, nothing below it
+// (possibly its dependency) would ever run
+Job* JobSystem::GetJob(uint index)
+{
+	Worker& worker = workers[index];
+
+	for (uint i = 0; i < worker.blocked.size(); ++i)
+	{
+		Job* job = worker.blocked[i];
+
+		if (job->dependency->IsDone())
+		{
+			worker.blocked[i] = worker.blocked.back();
+			worker.blocked.pop_back();
+			return job;
+		}
+	}
+
+	for (Job* job = worker.queue.Pop(); job != nullptr; job = worker.queue.Pop())
+	{
+		if (ReadyOrPark(worker, job))
+		{
+			return job;
+		}
+	}
+
+	for (uint i = 1; i < threadCount; ++i)
+	{
+		Job* job = workers[(index + i) % threadCount].queue.Steal();
+
+		if (job != nullptr && ReadyOrPark(worker, job))
+		{
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+// ---------------------------------------------
+bool JobSystem::ReadyOrPark(Worker& worker, Job* job)
+{
+	if (job->dependency == nullptr || job->dependency->IsDone())
+	{
+		return true;
+	}
+
+	worker.blocked.push_back(job);
+	return false;
+}
+
+// ---------------------------------------------
+void JobSystem::Execute(Job* job)
+{
+	--queuedJobs;
+
+	JobFunction function = job->function;
+	void* data = job->data;
+	uint begin = job->begin;
+	uint end = job->end;
+	JobCounter* counter = job->counter;
+
+	// The owner may hand the slot out again from here on. Releasing it only after
+	// running would deadlock a job that schedules more while its own slot is next
+	job->busy.store(false, std::memory_order_release);
+
+	function(data, begin, end);
+
+	if (counter != nullptr)
+	{
+		--counter->pending;
+	}
+}
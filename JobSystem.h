@@ -0,0 +1,172 @@
+#ifndef __JOBSYSTEM_H__
+#define __JOBSYSTEM_H__
+
+#include "Globals.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+// Jobs yet to start per thread, must be a power of two
+#define JOB_QUEUE_SIZE 4096
+#define JOB_QUEUE_MASK (JOB_QUEUE_SIZE - 1)
+
+// Smallest amount of items ParallelFor hands to a single job
+#define JOB_MIN_BATCH 64
+
+typedef void(*JobFunction)(void* data, uint begin, uint end);
+
+// Counts unfinished jobs. Can be waited on and used as a job dependency
+struct JobCounter
+{
+	JobCounter() : pending(0)
+	{}
+
+	bool IsDone() const
+	{
+		return pending.load() == 0;
+	}
+
+	std::atomic<int> pending;
+};
+
+struct Job
+{
+	Job() : busy(false)
+	{}
+
+	JobFunction function;
+	void* data;
+	uint begin;
+	uint end;
+	JobCounter* counter;
+	const JobCounter* dependency;
+	// Set from Run until the job starts executing, the pool slot can't be reused before
+	std::atomic<bool> busy;
+};
+
+// ----------------------------------------------------
+// Lock-free work-stealing deque (Chase-Lev). Only its
+// owner thread may Push and Pop, any thread may Steal
+// ----------------------------------------------------
+class JobQueue
+{
+public:
+
+	JobQueue();
+
+	void Push(Job* job);
+	Job* Pop();
+	Job* Steal();
+
+private:
+
+	std::atomic<long> top;
+	char padding[64];
+	std::atomic<long> bottom;
+	std::atomic<Job*> jobs[JOB_QUEUE_SIZE];
+};
+
+// ----------------------------------------------------
+// Engine wide job system: one thread per core (the main
+// thread plus a worker per remaining core), each with
+// its own deque and stealing from the others when idle
+// ----------------------------------------------------
+class JobSystem
+{
+public:
+
+	JobSystem();
+	~JobSystem();
+
+	bool Init(uint threads = 0);
+	bool CleanUp();
+
+	// Schedules function(data, begin, end). counter, if any, is incremented now and
+	// decremented once the job finishes. The job won't start before dependency is done.
+	// With JOB_QUEUE_SIZE jobs of this thread yet to start it runs other jobs until
+	// the oldest slot frees up
+	void Run(JobFunction function, void* data, JobCounter* counter = nullptr, const JobCounter* dependency = nullptr, uint begin = 0, uint end = 0);
+
+	// Runs other jobs on the calling thread until counter reaches zero
+	void Wait(const JobCounter& counter);
+
+	// Splits [0, count) in batches and calls function(begin, end) for each of them
+	// across all threads, returning when every batch is done
+	template<class FUNCTION>
+	void ParallelFor(uint count, FUNCTION function, uint minBatch = JOB_MIN_BATCH);
+
+	uint GetThreadCount() const;
+
+private:
+
+	struct Worker
+	{
+		JobQueue queue;
+		Job pool[JOB_QUEUE_SIZE];
+		uint allocated = 0;
+		// Jobs this thread took whose dependency wasn't done yet, only it touches them
+		std::vector<Job*> blocked;
+		std::thread thread;
+	};
+
+	void WorkerLoop(uint index);
+	Job* GetJob(uint index);
+	bool ReadyOrPark(Worker& worker, Job* job);
+	void Execute(Job* job);
+
+	template<class FUNCTION>
+	static void InvokeRange(void* data, uint begin, uint end)
+	{
+		(*(FUNCTION*)data)(begin, end);
+	}
+
+private:
+
+	Worker* workers = nullptr;
+	uint threadCount = 0;
+
+	std::atomic<int> queuedJobs;
+	std::atomic<int> sleepingWorkers;
+	std::atomic<bool> quit;
+	std::mutex wakeMutex;
+	std::condition_variable wakeCondition;
+};
+
+// ---------------------------------------------
+template<class FUNCTION>
+void JobSystem::ParallelFor(uint count, FUNCTION function, uint minBatch)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// A few batches per thread so faster threads can steal the leftovers
+	uint batches = threadCount * 4;
+	uint batchSize = (count + batches - 1) / batches;
+
+	if (batchSize < minBatch)
+	{
+		batchSize = minBatch;
+	}
+
+	if (batchSize >= count || threadCount <= 1)
+	{
+		function(0, count);
+		return;
+	}
+
+	JobCounter counter;
+
+	for (uint begin = 0; begin < count; begin += batchSize)
+	{
+		uint end = begin + batchSize < count ? begin + batchSize : count;
+		Run(&InvokeRange<FUNCTION>, &function, &counter, nullptr, begin, end);
+	}
+
+	Wait(counter);
+}
+
+#endif // __JOBSYSTEM_H__
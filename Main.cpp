@@ -2,6 +2,7 @@
 #include "Application.h"
 #include "Globals.h"
 #include "MemLeaks.h"
+#include "MemoryTracker.h"
 #include "Brofiler-1.1.2\Brofiler.h"
 
 #include "SDL/include/SDL.h"
@@ -23,6 +24,9 @@ int main(int argc, char ** argv)
 
 	//ReportMemoryLeaks();
 
+	// Bullet and parson blocks must all come from the tracked allocators
+	MemoryTracker::InstallHooks();
+
 	int main_return = EXIT_FAILURE;
 	main_states state = MAIN_CREATION;
 	Application* App = NULL;
@@ -35,7 +39,7 @@ int main(int argc, char ** argv)
 		case MAIN_CREATION:
 
 			LOG("-------------- Application Creation --------------");
-			App = new Application();
+			App = new Application(argc, argv);
 			state = MAIN_START;
 			break;
 
@@ -10,7 +10,8 @@
 
 #include <crtdbg.h>
 
-#ifdef _DEBUG
+// The memory tracker replaces operator new, the debug CRT one would bypass it
+#if defined(_DEBUG) && !MEMORY_TRACKING
 
 #ifndef DBG_NEW
 
@@ -0,0 +1,347 @@
+// ----------------------------------------------------
+// MemoryTracker.cpp
+// Per subsystem allocation counters and reports
+// ----------------------------------------------------
+
+#include "MemoryTracker.h"
+#include "Globals.h"
+#include "parson\parson.h"
+#include "Bullet/include/LinearMath/btAlignedAllocator.h"
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+// Keeps the block after it aligned as malloc would
+#define MEMORY_HEADER_SIZE 16
+
+static_assert(alignof(max_align_t) <= MEMORY_HEADER_SIZE, "Allocation header breaks alignment");
+
+// Zero initialized before any static constructor can allocate
+static std::atomic<size_t> tagBytes[Mem_TagCount];
+static std::atomic<size_t> tagPeakBytes[Mem_TagCount];
+static std::atomic<size_t> tagAllocations[Mem_TagCount];
+static std::atomic<size_t> tagTotalAllocations[Mem_TagCount];
+static std::atomic<uint> tagFrameAllocations[Mem_TagCount];
+static std::atomic<size_t> totalBytes;
+static std::atomic<size_t> peakBytes;
+static std::atomic<uint> frameAllocations;
+
+// Written by NextFrame on the main thread only
+static uint lastTagFrameAllocations[Mem_TagCount];
+static float frameHistory[MEMORY_FRAME_HISTORY];
+static uint frameHistoryOffset = 0;
+static uint lastFrameAllocations = 0;
+static uint maxFrameAllocations = 0;
+static uint flaggedFrames = 0;
+static uint frameCount = 0;
+static uint frameBudget = MEMORY_FRAME_BUDGET;
+
+static thread_local MemoryTag currentTag = Mem_General;
+
+static const char* tagNames[Mem_TagCount] = { "General", "Physics", "Render", "UI", "Audio", "Scene", "Parson" };
+
+// ---------------------------------------------
+static void UpdatePeak(std::atomic<size_t>& peak, size_t value)
+{
+	size_t current = peak.load(std::memory_order_relaxed);
+	while (value > current && peak.compare_exchange_weak(current, value, std::memory_order_relaxed) == false)
+	{}
+}
+
+// ---------------------------------------------
+MemoryScope::MemoryScope(MemoryTag tag) : previous(currentTag)
+{
+	currentTag = tag;
+}
+
+// ---------------------------------------------
+MemoryScope::~MemoryScope()
+{
+	currentTag = previous;
+}
+
+// ---------------------------------------------
+void* MemoryTracker::Allocate(size_t bytes, MemoryTag tag)
+{
+	char* block = (char*)malloc(bytes + MEMORY_HEADER_SIZE);
+	if (block == nullptr)
+	{
+		return nullptr;
+	}
+
+	*(size_t*)block = bytes;
+	*(MemoryTag*)(block + sizeof(size_t)) = tag;
+
+	UpdatePeak(tagPeakBytes[tag], tagBytes[tag].fetch_add(bytes, std::memory_order_relaxed) + bytes);
+	UpdatePeak(peakBytes, totalBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+	tagAllocations[tag].fetch_add(1, std::memory_order_relaxed);
+	tagTotalAllocations[tag].fetch_add(1, std::memory_order_relaxed);
+	tagFrameAllocations[tag].fetch_add(1, std::memory_order_relaxed);
+	frameAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	return block + MEMORY_HEADER_SIZE;
+}
+
+// ---------------------------------------------
+void MemoryTracker::Free(void* memory)
+{
+	if (memory == nullptr)
+	{
+		return;
+	}
+
+	char* block = (char*)memory - MEMORY_HEADER_SIZE;
+	size_t bytes = *(size_t*)block;
+	MemoryTag tag = *(MemoryTag*)(block + sizeof(size_t));
+
+	tagBytes[tag].fetch_sub(bytes, std::memory_order_relaxed);
+	tagAllocations[tag].fetch_sub(1, std::memory_order_relaxed);
+	totalBytes.fetch_sub(bytes, std::memory_order_relaxed);
+
+	free(block);
+}
+
+#if MEMORY_TRACKING
+
+// ---------------------------------------------
+static void* PhysicsAlloc(size_t bytes)
+{
+	return MemoryTracker::Allocate(bytes, Mem_Physics);
+}
+
+// ---------------------------------------------
+static void* ParsonAlloc(size_t bytes)
+{
+	return MemoryTracker::Allocate(bytes, Mem_Parson);
+}
+
+// ---------------------------------------------
+static void TrackedFree(void* memory)
+{
+	MemoryTracker::Free(memory);
+}
+
+// ---------------------------------------------
+static void* TrackedNew(size_t bytes)
+{
+	void* memory = MemoryTracker::Allocate(bytes > 0 ? bytes : 1, currentTag);
+
+	// Built without exceptions, there is no bad_alloc to throw
+	if (memory == nullptr)
+	{
+		abort();
+	}
+	return memory;
+}
+
+void* operator new(size_t bytes)
+{
+	return TrackedNew(bytes);
+}
+
+void* operator new[](size_t bytes)
+{
+	return TrackedNew(bytes);
+}
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept
+{
+	return MemoryTracker::Allocate(bytes > 0 ? bytes : 1, currentTag);
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept
+{
+	return MemoryTracker::Allocate(bytes > 0 ? bytes : 1, currentTag);
+}
+
+void operator delete(void* memory) noexcept
+{
+	MemoryTracker::Free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	MemoryTracker::Free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	MemoryTracker::Free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	MemoryTracker::Free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	MemoryTracker::Free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	MemoryTracker::Free(memory);
+}
+
+#endif // MEMORY_TRACKING
+
+// ---------------------------------------------
+void MemoryTracker::InstallHooks()
+{
+#if MEMORY_TRACKING
+	btAlignedAllocSetCustom(&PhysicsAlloc, &TrackedFree);
+	json_set_allocation_functions(&ParsonAlloc, &TrackedFree);
+#endif
+}
+
+// ---------------------------------------------
+void MemoryTracker::NextFrame()
+{
+	lastFrameAllocations = frameAllocations.exchange(0, std::memory_order_relaxed);
+
+	for (uint i = 0; i < Mem_TagCount; ++i)
+	{
+		lastTagFrameAllocations[i] = tagFrameAllocations[i].exchange(0, std::memory_order_relaxed);
+	}
+
+	frameHistory[frameHistoryOffset] = (float)lastFrameAllocations;
+	frameHistoryOffset = (frameHistoryOffset + 1) % MEMORY_FRAME_HISTORY;
+
+	if (lastFrameAllocations > maxFrameAllocations)
+	{
+		maxFrameAllocations = lastFrameAllocations;
+	}
+
+	if (lastFrameAllocations > frameBudget)
+	{
+		++flaggedFrames;
+	}
+
+	++frameCount;
+}
+
+// ---------------------------------------------
+void MemoryTracker::SetFrameBudget(uint allocations)
+{
+	frameBudget = allocations;
+}
+
+// ---------------------------------------------
+uint MemoryTracker::GetFrameBudget()
+{
+	return frameBudget;
+}
+
+// ---------------------------------------------
+void MemoryTracker::GetTagStats(MemoryTag tag, MemoryTagStats& stats)
+{
+	stats.bytes = tagBytes[tag].load(std::memory_order_relaxed);
+	stats.peakBytes = tagPeakBytes[tag].load(std::memory_order_relaxed);
+	stats.allocations = tagAllocations[tag].load(std::memory_order_relaxed);
+	stats.totalAllocations = tagTotalAllocations[tag].load(std::memory_order_relaxed);
+	stats.frameAllocations = lastTagFrameAllocations[tag];
+}
+
+// ---------------------------------------------
+const char* MemoryTracker::GetTagName(MemoryTag tag)
+{
+	return tag < Mem_TagCount ? tagNames[tag] : "Unknown";
+}
+
+// ---------------------------------------------
+size_t MemoryTracker::GetTotalBytes()
+{
+	return totalBytes.load(std::memory_order_relaxed);
+}
+
+// ---------------------------------------------
+size_t MemoryTracker::GetPeakBytes()
+{
+	return peakBytes.load(std::memory_order_relaxed);
+}
+
+// ---------------------------------------------
+const float* MemoryTracker::GetFrameHistory()
+{
+	return frameHistory;
+}
+
+// ---------------------------------------------
+uint MemoryTracker::GetFrameHistoryOffset()
+{
+	return frameHistoryOffset;
+}
+
+// ---------------------------------------------
+uint MemoryTracker::GetLastFrameAllocations()
+{
+	return lastFrameAllocations;
+}
+
+// ---------------------------------------------
+uint MemoryTracker::GetMaxFrameAllocations()
+{
+	return maxFrameAllocations;
+}
+
+// ---------------------------------------------
+uint MemoryTracker::GetFlaggedFrames()
+{
+	return flaggedFrames;
+}
+
+// ---------------------------------------------
+uint MemoryTracker::GetFrameCount()
+{
+	return frameCount;
+}
+
+// ---------------------------------------------
+bool MemoryTracker::SaveReport(const char* path)
+{
+	// Taken before building the document, which allocates through parson itself
+	MemoryTagStats stats[Mem_TagCount];
+	for (uint i = 0; i < Mem_TagCount; ++i)
+	{
+		GetTagStats((MemoryTag)i, stats[i]);
+	}
+	size_t total = GetTotalBytes();
+	size_t peak = GetPeakBytes();
+
+	JSON_Value* rootValue = json_value_init_object();
+	JSON_Object* root = json_value_get_object(rootValue);
+
+	json_object_set_boolean(root, "tracking", MEMORY_TRACKING != 0);
+	json_object_set_number(root, "bytes", (double)total);
+	json_object_set_number(root, "peakBytes", (double)peak);
+	json_object_set_number(root, "frames", frameCount);
+	json_object_set_number(root, "frameBudget", frameBudget);
+	json_object_set_number(root, "flaggedFrames", flaggedFrames);
+	json_object_set_number(root, "maxFrameAllocations", maxFrameAllocations);
+	json_object_set_number(root, "lastFrameAllocations", lastFrameAllocations);
+
+	JSON_Value* tagsValue = json_value_init_array();
+	JSON_Array* tags = json_value_get_array(tagsValue);
+
+	for (uint i = 0; i < Mem_TagCount; ++i)
+	{
+		JSON_Value* tagValue = json_value_init_object();
+		JSON_Object* tag = json_value_get_object(tagValue);
+
+		json_object_set_string(tag, "name", tagNames[i]);
+		json_object_set_number(tag, "bytes", (double)stats[i].bytes);
+		json_object_set_number(tag, "peakBytes", (double)stats[i].peakBytes);
+		json_object_set_number(tag, "allocations", (double)stats[i].allocations);
+		json_object_set_number(tag, "totalAllocations", (double)stats[i].totalAllocations);
+		json_object_set_number(tag, "lastFrameAllocations", stats[i].frameAllocations);
+
+		json_array_append_value(tags, tagValue);
+	}
+	json_object_set_value(root, "tags", tagsValue);
+
+	bool ret = json_serialize_to_file_pretty(rootValue, path) == JSONSuccess;
+	json_value_free(rootValue);
+
+	return ret;
+}
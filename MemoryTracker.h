@@ -0,0 +1,91 @@
+#ifndef __MEMORYTRACKER_H__
+#define __MEMORYTRACKER_H__
+
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+// Frames kept for the allocation graph
+#define MEMORY_FRAME_HISTORY 120
+// Frames allocating more often than this are flagged
+#define MEMORY_FRAME_BUDGET 64
+#define MEMORY_REPORT "memory.json"
+
+// Subsystem an allocation is charged to. Modules tag their own stages,
+// Bullet and parson allocations are always tagged through their hooks
+enum MemoryTag
+{
+	Mem_General = 0,
+	Mem_Physics,
+	Mem_Render,
+	Mem_UI,
+	Mem_Audio,
+	Mem_Scene,
+	Mem_Parson,
+	Mem_TagCount
+};
+
+// Snapshot of one tag. bytes and allocations are what is live now
+struct MemoryTagStats
+{
+	size_t bytes = 0;
+	size_t peakBytes = 0;
+	size_t allocations = 0;
+	size_t totalAllocations = 0;
+	uint frameAllocations = 0;
+};
+
+// Charges operator new on the calling thread to a tag while alive
+class MemoryScope
+{
+public:
+
+	MemoryScope(MemoryTag tag);
+	~MemoryScope();
+
+private:
+
+	MemoryTag previous;
+};
+
+// ----------------------------------------------------
+// Counts live bytes and allocations per subsystem tag by
+// replacing global new/delete and the Bullet and parson
+// allocators. Each block carries a small header with its
+// size and tag, counters are relaxed atomics so any thread
+// can allocate. Built only with MEMORY_TRACKING set
+// ----------------------------------------------------
+class MemoryTracker
+{
+public:
+
+	// Before anything allocates through Bullet or parson
+	static void InstallHooks();
+
+	// Closes the allocation counts of the frame that just ended
+	static void NextFrame();
+
+	static void* Allocate(size_t bytes, MemoryTag tag);
+	static void Free(void* memory);
+
+	static void SetFrameBudget(uint allocations);
+	static uint GetFrameBudget();
+
+	static void GetTagStats(MemoryTag tag, MemoryTagStats& stats);
+	static const char* GetTagName(MemoryTag tag);
+
+	static size_t GetTotalBytes();
+	static size_t GetPeakBytes();
+
+	// Allocations per frame, oldest at GetFrameHistoryOffset()
+	static const float* GetFrameHistory();
+	static uint GetFrameHistoryOffset();
+	static uint GetLastFrameAllocations();
+	static uint GetMaxFrameAllocations();
+	static uint GetFlaggedFrames();
+	static uint GetFrameCount();
+
+	static bool SaveReport(const char* path);
+};
+
+#endif // __MEMORYTRACKER_H__
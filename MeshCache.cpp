@@ -0,0 +1,398 @@
+// ----------------------------------------------------
+// MeshCache.cpp
+// Primitive geometry built once into VBO/IBO pairs
+// ----------------------------------------------------
+
+#include "MeshCache.h"
+#include "Glew\include\glew.h"
+#include <math.h>
+
+#define MESH_VERTEX_STRIDE (6 * sizeof(float))
+
+// Projected radius, in pixels, needed to move up to the next sphere level
+static const float sphereLodPixels[SPHERE_LOD_LEVELS - 1] = { 16.0f, 48.0f, 128.0f };
+
+static void PushVertex(std::vector<float>& vertices, float x, float y, float z, float nx, float ny, float nz)
+{
+	vertices.push_back(x);
+	vertices.push_back(y);
+	vertices.push_back(z);
+	vertices.push_back(nx);
+	vertices.push_back(ny);
+	vertices.push_back(nz);
+}
+
+// Two triangles for the quad starting at vertex first, in the order the vertices were pushed
+static void PushQuad(std::vector<uint>& indices, uint first)
+{
+	indices.push_back(first);
+	indices.push_back(first + 1);
+	indices.push_back(first + 2);
+	indices.push_back(first);
+	indices.push_back(first + 2);
+	indices.push_back(first + 3);
+}
+
+// ---------------------------------------------
+void PrimitiveMesh::Draw() const
+{
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glVertexPointer(3, GL_FLOAT, MESH_VERTEX_STRIDE, (void*)0);
+	glNormalPointer(GL_FLOAT, MESH_VERTEX_STRIDE, (void*)(3 * sizeof(float)));
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, (void*)0);
+
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// ---------------------------------------------
+bool MeshCache::MeshKey::operator<(const MeshKey& other) const
+{
+	if (shape != other.shape) return shape < other.shape;
+	if (a != other.a) return a < other.a;
+	if (b != other.b) return b < other.b;
+	if (c != other.c) return c < other.c;
+	return segments < other.segments;
+}
+
+// ---------------------------------------------
+MeshCache::MeshCache()
+{}
+
+// ---------------------------------------------
+MeshCache::~MeshCache()
+{}
+
+// ---------------------------------------------
+const PrimitiveMesh* MeshCache::GetCube(float sizeX, float sizeY, float sizeZ)
+{
+	MeshKey key = { Mesh_Cube, sizeX, sizeY, sizeZ, 0 };
+	const PrimitiveMesh* mesh = Find(key);
+	if (mesh != nullptr)
+	{
+		return mesh;
+	}
+
+	float sx = sizeX * 0.5f;
+	float sy = sizeY * 0.5f;
+	float sz = sizeZ * 0.5f;
+
+	std::vector<float> vertices;
+	std::vector<uint> indices;
+	vertices.reserve(24 * 6);
+	indices.reserve(36);
+
+	PushVertex(vertices, -sx, -sy, sz, 0.0f, 0.0f, 1.0f);
+	PushVertex(vertices,  sx, -sy, sz, 0.0f, 0.0f, 1.0f);
+	PushVertex(vertices,  sx,  sy, sz, 0.0f, 0.0f, 1.0f);
+	PushVertex(vertices, -sx,  sy, sz, 0.0f, 0.0f, 1.0f);
+	PushQuad(indices, 0);
+
+	PushVertex(vertices,  sx, -sy, -sz, 0.0f, 0.0f, -1.0f);
+	PushVertex(vertices, -sx, -sy, -sz, 0.0f, 0.0f, -1.0f);
+	PushVertex(vertices, -sx,  sy, -sz, 0.0f, 0.0f, -1.0f);
+	PushVertex(vertices,  sx,  sy, -sz, 0.0f, 0.0f, -1.0f);
+	PushQuad(indices, 4);
+
+	PushVertex(vertices, sx, -sy,  sz, 1.0f, 0.0f, 0.0f);
+	PushVertex(vertices, sx, -sy, -sz, 1.0f, 0.0f, 0.0f);
+	PushVertex(vertices, sx,  sy, -sz, 1.0f, 0.0f, 0.0f);
+	PushVertex(vertices, sx,  sy,  sz, 1.0f, 0.0f, 0.0f);
+	PushQuad(indices, 8);
+
+	PushVertex(vertices, -sx, -sy, -sz, -1.0f, 0.0f, 0.0f);
+	PushVertex(vertices, -sx, -sy,  sz, -1.0f, 0.0f, 0.0f);
+	PushVertex(vertices, -sx,  sy,  sz, -1.0f, 0.0f, 0.0f);
+	PushVertex(vertices, -sx,  sy, -sz, -1.0f, 0.0f, 0.0f);
+	PushQuad(indices, 12);
+
+	PushVertex(vertices, -sx, sy,  sz, 0.0f, 1.0f, 0.0f);
+	PushVertex(vertices,  sx, sy,  sz, 0.0f, 1.0f, 0.0f);
+	PushVertex(vertices,  sx, sy, -sz, 0.0f, 1.0f, 0.0f);
+	PushVertex(vertices, -sx, sy, -sz, 0.0f, 1.0f, 0.0f);
+	PushQuad(indices, 16);
+
+	PushVertex(vertices, -sx, -sy, -sz, 0.0f, -1.0f, 0.0f);
+	PushVertex(vertices,  sx, -sy, -sz, 0.0f, -1.0f, 0.0f);
+	PushVertex(vertices,  sx, -sy,  sz, 0.0f, -1.0f, 0.0f);
+	PushVertex(vertices, -sx, -sy,  sz, 0.0f, -1.0f, 0.0f);
+	PushQuad(indices, 20);
+
+	return Upload(key, vertices, indices);
+}
+
+// ---------------------------------------------
+// Along the X axis, sin/cos are only evaluated here once per segment
+const PrimitiveMesh* MeshCache::GetCylinder(float radius, float height, uint segments)
+{
+	MeshKey key = { Mesh_Cylinder, radius, height, 0.0f, segments };
+	const PrimitiveMesh* mesh = Find(key);
+	if (mesh != nullptr)
+	{
+		return mesh;
+	}
+
+	float hx = height * 0.5f;
+
+	std::vector<float> vertices;
+	std::vector<uint> indices;
+	vertices.reserve((segments + 1) * 4 * 6 + 2 * 6);
+	indices.reserve(segments * 12);
+
+	// Cover: a top and bottom vertex per ring step, the seam is duplicated
+	for (uint i = 0; i <= segments; ++i)
+	{
+		float a = 360.0f * DEGTORAD * i / segments;
+		float c = cosf(a);
+		float s = sinf(a);
+
+		PushVertex(vertices,  hx, radius * c, radius * s, 0.0f, c, s);
+		PushVertex(vertices, -hx, radius * c, radius * s, 0.0f, c, s);
+	}
+
+	for (uint i = 0; i < segments; ++i)
+	{
+		uint top = i * 2;
+		uint bottom = top + 1;
+
+		indices.push_back(bottom);
+		indices.push_back(bottom + 2);
+		indices.push_back(top);
+		indices.push_back(top);
+		indices.push_back(bottom + 2);
+		indices.push_back(top + 2);
+	}
+
+	// Caps, fanned around a center vertex
+	uint topCenter = vertices.size() / 6;
+	PushVertex(vertices, hx, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+	for (uint i = 0; i <= segments; ++i)
+	{
+		float a = 360.0f * DEGTORAD * i / segments;
+		PushVertex(vertices, hx, radius * cosf(a), radius * sinf(a), 1.0f, 0.0f, 0.0f);
+	}
+
+	uint bottomCenter = vertices.size() / 6;
+	PushVertex(vertices, -hx, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
+	for (uint i = 0; i <= segments; ++i)
+	{
+		float a = 360.0f * DEGTORAD * i / segments;
+		PushVertex(vertices, -hx, radius * cosf(a), radius * sinf(a), -1.0f, 0.0f, 0.0f);
+	}
+
+	for (uint i = 0; i < segments; ++i)
+	{
+		indices.push_back(topCenter);
+		indices.push_back(topCenter + 1 + i);
+		indices.push_back(topCenter + 2 + i);
+
+		indices.push_back(bottomCenter);
+		indices.push_back(bottomCenter + 2 + i);
+		indices.push_back(bottomCenter + 1 + i);
+	}
+
+	return Upload(key, vertices, indices);
+}
+
+// ---------------------------------------------
+// Same grid the immediate mode plane used to draw, one quad per unit
+const PrimitiveMesh* MeshCache::GetPlane(float extent)
+{
+	MeshKey key = { Mesh_Plane, extent, 0.0f, 0.0f, 0 };
+	const PrimitiveMesh* mesh = Find(key);
+	if (mesh != nullptr)
+	{
+		return mesh;
+	}
+
+	float d = extent;
+
+	std::vector<float> vertices;
+	std::vector<uint> indices;
+
+	for (float i = -d; i <= d; i += 1.0f)
+	{
+		uint first = vertices.size() / 6;
+
+		PushVertex(vertices, i, 0.0f, -d, 0.0f, 1.0f, 0.0f);
+		PushVertex(vertices, i, 0.0f, d, 0.0f, 1.0f, 0.0f);
+		PushVertex(vertices, -d, 0.0f, i, 0.0f, 1.0f, 0.0f);
+		PushVertex(vertices, d, 0.0f, i, 0.0f, 1.0f, 0.0f);
+		PushQuad(indices, first);
+	}
+
+	return Upload(key, vertices, indices);
+}
+
+// ---------------------------------------------
+// Icosahedron subdivided lod + 1 times, every vertex on the unit sphere
+// so positions double as normals
+const PrimitiveMesh* MeshCache::GetSphere(uint lod)
+{
+	if (lod >= SPHERE_LOD_LEVELS)
+	{
+		lod = SPHERE_LOD_LEVELS - 1;
+	}
+
+	MeshKey key = { Mesh_Sphere, 1.0f, 0.0f, 0.0f, lod };
+	const PrimitiveMesh* mesh = Find(key);
+	if (mesh != nullptr)
+	{
+		return mesh;
+	}
+
+	const float t = (1.0f + sqrtf(5.0f)) * 0.5f;
+	const float corners[12][3] = {
+		{ -1, t, 0 }, { 1, t, 0 }, { -1, -t, 0 }, { 1, -t, 0 },
+		{ 0, -1, t }, { 0, 1, t }, { 0, -1, -t }, { 0, 1, -t },
+		{ t, 0, -1 }, { t, 0, 1 }, { -t, 0, -1 }, { -t, 0, 1 }
+	};
+	const uint faces[60] = {
+		0, 11, 5,	0, 5, 1,	0, 1, 7,	0, 7, 10,	0, 10, 11,
+		1, 5, 9,	5, 11, 4,	11, 10, 2,	10, 7, 6,	7, 1, 8,
+		3, 9, 4,	3, 4, 2,	3, 2, 6,	3, 6, 8,	3, 8, 9,
+		4, 9, 5,	2, 4, 11,	6, 2, 10,	8, 6, 7,	9, 8, 1
+	};
+
+	std::vector<vec3> points;
+	for (uint i = 0; i < 12; ++i)
+	{
+		points.push_back(normalize(vec3(corners[i][0], corners[i][1], corners[i][2])));
+	}
+	std::vector<uint> indices(faces, faces + 60);
+
+	for (uint level = 0; level <= lod; ++level)
+	{
+		// Edge midpoints shared between the two triangles touching them
+		std::map<uint64, uint> midpoints;
+		std::vector<uint> subdivided;
+		subdivided.reserve(indices.size() * 4);
+
+		for (uint f = 0; f < indices.size(); f += 3)
+		{
+			uint corner[3] = { indices[f], indices[f + 1], indices[f + 2] };
+			uint middle[3];
+
+			for (uint e = 0; e < 3; ++e)
+			{
+				uint a = corner[e];
+				uint b = corner[(e + 1) % 3];
+				uint64 edge = a < b ? ((uint64)a << 32) | b : ((uint64)b << 32) | a;
+
+				std::map<uint64, uint>::iterator it = midpoints.find(edge);
+				if (it != midpoints.end())
+				{
+					middle[e] = it->second;
+				}
+				else
+				{
+					middle[e] = points.size();
+					points.push_back(normalize((points[a] + points[b]) * 0.5f));
+					midpoints[edge] = middle[e];
+				}
+			}
+
+			uint triangles[12] = {
+				corner[0], middle[0], middle[2],
+				corner[1], middle[1], middle[0],
+				corner[2], middle[2], middle[1],
+				middle[0], middle[1], middle[2]
+			};
+			subdivided.insert(subdivided.end(), triangles, triangles + 12);
+		}
+
+		indices.swap(subdivided);
+	}
+
+	std::vector<float> vertices;
+	vertices.reserve(points.size() * 6);
+	for (uint i = 0; i < points.size(); ++i)
+	{
+		PushVertex(vertices, points[i].x, points[i].y, points[i].z, points[i].x, points[i].y, points[i].z);
+	}
+
+	return Upload(key, vertices, indices);
+}
+
+// ---------------------------------------------
+void MeshCache::SetViewPosition(const vec3& position)
+{
+	viewPosition = position;
+}
+
+// ---------------------------------------------
+void MeshCache::SetViewport(float height, float fovY)
+{
+	projectionScale = height / (2.0f * tanf(fovY * 0.5f * DEGTORAD));
+}
+
+// ---------------------------------------------
+uint MeshCache::SelectSphereLod(const vec3& center, float radius) const
+{
+	float distance = length(center - viewPosition);
+	if (distance <= radius)
+	{
+		return SPHERE_LOD_LEVELS - 1;
+	}
+
+	float pixels = radius * projectionScale / distance;
+
+	uint lod = 0;
+	while (lod < SPHERE_LOD_LEVELS - 1 && pixels >= sphereLodPixels[lod])
+	{
+		++lod;
+	}
+
+	return lod;
+}
+
+// ---------------------------------------------
+void MeshCache::Clear()
+{
+	for (std::map<MeshKey, PrimitiveMesh>::iterator it = meshes.begin(); it != meshes.end(); ++it)
+	{
+		glDeleteBuffers(1, &it->second.vertexBuffer);
+		glDeleteBuffers(1, &it->second.indexBuffer);
+	}
+	meshes.clear();
+}
+
+// ---------------------------------------------
+uint MeshCache::GetMeshCount() const
+{
+	return meshes.size();
+}
+
+// ---------------------------------------------
+const PrimitiveMesh* MeshCache::Find(const MeshKey& key) const
+{
+	std::map<MeshKey, PrimitiveMesh>::const_iterator it = meshes.find(key);
+	return it != meshes.end() ? &it->second : nullptr;
+}
+
+// ---------------------------------------------
+const PrimitiveMesh* MeshCache::Upload(const MeshKey& key, const std::vector<float>& vertices, const std::vector<uint>& indices)
+{
+	PrimitiveMesh& mesh = meshes[key];
+
+	glGenBuffers(1, &mesh.vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+	glGenBuffers(1, &mesh.indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint), indices.data(), GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	mesh.indexCount = indices.size();
+
+	return &mesh;
+}
@@ -0,0 +1,77 @@
+#ifndef __MESHCACHE_H__
+#define __MESHCACHE_H__
+
+#include "Globals.h"
+#include "glmath.h"
+#include <map>
+#include <vector>
+
+enum MeshShape
+{
+	Mesh_Cube,
+	Mesh_Cylinder,
+	Mesh_Plane,
+	Mesh_Sphere
+};
+
+// Unit icospheres, level n is subdivided n + 1 times
+#define SPHERE_LOD_LEVELS 4
+
+// ----------------------------------------------------
+// Interleaved position + normal vertices and triangle
+// indices, uploaded once and drawn through client arrays
+// ----------------------------------------------------
+struct PrimitiveMesh
+{
+	uint vertexBuffer = 0;
+	uint indexBuffer = 0;
+	uint indexCount = 0;
+
+	void Draw() const;
+};
+
+class MeshCache
+{
+public:
+
+	MeshCache();
+	~MeshCache();
+
+	const PrimitiveMesh* GetCube(float sizeX, float sizeY, float sizeZ);
+	const PrimitiveMesh* GetCylinder(float radius, float height, uint segments);
+	const PrimitiveMesh* GetPlane(float extent);
+	const PrimitiveMesh* GetSphere(uint lod);
+
+	// Sphere LOD picks from the projected radius in pixels
+	void SetViewPosition(const vec3& position);
+	void SetViewport(float height, float fovY);
+	uint SelectSphereLod(const vec3& center, float radius) const;
+
+	// Needs the GL context still alive
+	void Clear();
+
+	uint GetMeshCount() const;
+
+private:
+
+	struct MeshKey
+	{
+		MeshShape shape;
+		float a, b, c;
+		uint segments;
+
+		bool operator<(const MeshKey& other) const;
+	};
+
+	const PrimitiveMesh* Find(const MeshKey& key) const;
+	const PrimitiveMesh* Upload(const MeshKey& key, const std::vector<float>& vertices, const std::vector<uint>& indices);
+
+private:
+
+	std::map<MeshKey, PrimitiveMesh> meshes;
+
+	vec3 viewPosition;
+	float projectionScale = 0.0f;
+};
+
+#endif // __MESHCACHE_H__
@@ -0,0 +1,136 @@
+// ----------------------------------------------------
+// MicroBenchmark.cpp
+// Repeated timing of isolated engine routines
+// ----------------------------------------------------
+
+#include "MicroBenchmark.h"
+#include "MathGeo\Time\Clock.h"
+#include "parson\parson.h"
+
+// ---------------------------------------------
+MicroBenchmark::MicroBenchmark()
+{}
+
+// ---------------------------------------------
+MicroBenchmark::~MicroBenchmark()
+{}
+
+// ---------------------------------------------
+uint64 MicroBenchmark::Start() const
+{
+	return math::Clock::Tick();
+}
+
+// ---------------------------------------------
+double MicroBenchmark::ReadMs(uint64 start) const
+{
+	return math::Clock::MillisecondsSinceD(start);
+}
+
+// ---------------------------------------------
+void MicroBenchmark::Check(const char* suite, const char* name, bool passed, double maxError)
+{
+	CheckResult check;
+	check.suite = suite;
+	check.name = name;
+	check.passed = passed;
+	check.maxError = maxError;
+
+	checks.push_back(check);
+}
+
+// ---------------------------------------------
+uint MicroBenchmark::GetFailedChecks() const
+{
+	uint failed = 0;
+	for (uint i = 0; i < checks.size(); ++i)
+	{
+		if (checks[i].passed == false)
+		{
+			++failed;
+		}
+	}
+	return failed;
+}
+
+// ---------------------------------------------
+void MicroBenchmark::Log() const
+{
+	for (uint i = 0; i < results.size(); ++i)
+	{
+		LOG("[%s] %s: best %.4f ms, mean %.4f ms over %u runs", results[i].suite.c_str(), results[i].name.c_str(), results[i].bestMs, results[i].meanMs, results[i].repeats);
+	}
+
+	for (uint i = 0; i < checks.size(); ++i)
+	{
+		LOG("[%s] check %s: %s, max error %g", checks[i].suite.c_str(), checks[i].name.c_str(), checks[i].passed ? "passed" : "FAILED", checks[i].maxError);
+	}
+}
+
+// ---------------------------------------------
+bool MicroBenchmark::SaveReport(const char* path) const
+{
+	JSON_Value* rootValue = json_value_init_object();
+	JSON_Object* root = json_value_get_object(rootValue);
+
+	for (uint i = 0; i < results.size(); ++i)
+	{
+		JSON_Object* suite = json_object_get_object(root, results[i].suite.c_str());
+		if (suite == nullptr)
+		{
+			json_object_set_value(root, results[i].suite.c_str(), json_value_init_object());
+			suite = json_object_get_object(root, results[i].suite.c_str());
+		}
+
+		JSON_Value* caseValue = json_value_init_object();
+		JSON_Object* caseObject = json_value_get_object(caseValue);
+
+		json_object_set_number(caseObject, "repeats", results[i].repeats);
+		json_object_set_number(caseObject, "best", results[i].bestMs);
+		json_object_set_number(caseObject, "mean", results[i].meanMs);
+
+		json_object_set_value(suite, results[i].name.c_str(), caseValue);
+	}
+
+	if (checks.empty() == false)
+	{
+		JSON_Value* checksValue = json_value_init_array();
+		JSON_Array* checksArray = json_value_get_array(checksValue);
+
+		for (uint i = 0; i < checks.size(); ++i)
+		{
+			JSON_Value* checkValue = json_value_init_object();
+			JSON_Object* check = json_value_get_object(checkValue);
+
+			json_object_set_string(check, "suite", checks[i].suite.c_str());
+			json_object_set_string(check, "name", checks[i].name.c_str());
+			json_object_set_boolean(check, "passed", checks[i].passed);
+			json_object_set_number(check, "maxError", checks[i].maxError);
+
+			json_array_append_value(checksArray, checkValue);
+		}
+		json_object_set_value(root, "checks", checksValue);
+	}
+
+	bool ret = json_serialize_to_file_pretty(rootValue, path) == JSONSuccess;
+	json_value_free(rootValue);
+
+	return ret;
+}
+
+// ---------------------------------------------
+float RandomRange(uint& seed, float min, float max)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return min + (max - min) * ((seed >> 8) / 16777216.0f);
+}
+
+// ---------------------------------------------
+// One statement per component, argument evaluation order is unspecified
+vec3 RandomVec3(uint& seed, float min, float max)
+{
+	float x = RandomRange(seed, min, max);
+	float y = RandomRange(seed, min, max);
+	float z = RandomRange(seed, min, max);
+	return vec3(x, y, z);
+}
@@ -0,0 +1,102 @@
+#ifndef __MICROBENCHMARK_H__
+#define __MICROBENCHMARK_H__
+
+#include "Globals.h"
+#include "glmath.h"
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+// ----------------------------------------------------
+// Times small engine routines in isolation: each case
+// runs a number of repeats and keeps the best and mean
+// times. Cases return a value so the work isn't elided.
+// Suites can also record correctness checks of the code
+// they time, reported next to the timings
+// ----------------------------------------------------
+class MicroBenchmark
+{
+public:
+
+	MicroBenchmark();
+	~MicroBenchmark();
+
+	template<class FUNCTION>
+	void Run(const char* suite, const char* name, uint repeats, FUNCTION function);
+
+	// maxError is the largest difference found against the reference
+	void Check(const char* suite, const char* name, bool passed, double maxError);
+	uint GetFailedChecks() const;
+
+	void Log() const;
+	bool SaveReport(const char* path) const;
+
+private:
+
+	struct Result
+	{
+		std::string suite;
+		std::string name;
+		uint repeats;
+		double bestMs;
+		double meanMs;
+	};
+
+	struct CheckResult
+	{
+		std::string suite;
+		std::string name;
+		bool passed;
+		double maxError;
+	};
+
+	uint64 Start() const;
+	double ReadMs(uint64 start) const;
+
+private:
+
+	std::vector<Result> results;
+	std::vector<CheckResult> checks;
+	volatile uint64 sink = 0;
+};
+
+// ---------------------------------------------
+template<class FUNCTION>
+void MicroBenchmark::Run(const char* suite, const char* name, uint repeats, FUNCTION function)
+{
+	Result result;
+	result.suite = suite;
+	result.name = name;
+	result.repeats = repeats;
+	result.bestMs = 0.0;
+	result.meanMs = 0.0;
+
+	for (uint i = 0; i < repeats; ++i)
+	{
+		uint64 start = Start();
+		sink = sink + (uint64)function();
+		double ms = ReadMs(start);
+
+		result.meanMs += ms / repeats;
+		if (i == 0 || ms < result.bestMs)
+		{
+			result.bestMs = ms;
+		}
+	}
+
+	results.push_back(result);
+}
+
+// Reproducible values in [min, max) for suite data, the caller owns the seed
+float RandomRange(uint& seed, float min, float max);
+vec3 RandomVec3(uint& seed, float min, float max);
+
+// Suites, each in the file of what they measure
+void RunContainerBenchmarks(MicroBenchmark& bench);
+void RunDynArrayBenchmarks(MicroBenchmark& bench);
+void RunGlmathBenchmarks(MicroBenchmark& bench);
+void RunTransformBenchmarks(MicroBenchmark& bench, JobSystem& jobs);
+void RunAABBTreeBenchmarks(MicroBenchmark& bench);
+
+#endif // __MICROBENCHMARK_H__
@@ -2,10 +2,14 @@
 #define __MODULE_H__
 
 #include <string>
+#include <vector>
 #include "parson\parson.h"
+#include "Globals.h"
+#include "MemoryTracker.h"
 
 class Application;
 struct PhysBody3D;
+struct ContactEvent;
 
 class Module
 {
@@ -16,12 +20,54 @@ public:
 	Application* App;
 	std::string name;
 
-	Module(Application* parent, bool start_enabled = true) : App(parent)
+	// Scheduling, filled in DeclareDependencies()
+	std::vector<Module*> reads;
+	std::vector<Module*> writes;
+	bool mainThread[STAGE_COUNT] = { false, false, false };
+
+	// Subsystem charged with what the module allocates from Init to CleanUp
+	MemoryTag memoryTag = Mem_General;
+
+	Module(Application* parent, bool start_enabled = true) : enabled(start_enabled), App(parent)
 	{}
 
 	virtual ~Module()
 	{}
 
+	bool IsEnabled() const
+	{
+		return enabled;
+	}
+
+	// Called once all modules exist. Reads() makes the other module's stage run
+	// first, Writes() keeps both from overlapping in registration order
+	virtual void DeclareDependencies()
+	{}
+
+	void Reads(Module* module)
+	{
+		reads.push_back(module);
+	}
+
+	void Writes(Module* module)
+	{
+		writes.push_back(module);
+	}
+
+	// For stages touching the GL context, the SDL window or ImGui
+	void RequireMainThread(update_stage stage)
+	{
+		mainThread[stage] = true;
+	}
+
+	void RequireMainThread()
+	{
+		for (int i = 0; i < STAGE_COUNT; ++i)
+		{
+			mainThread[i] = true;
+		}
+	}
+
 	virtual bool Init(JSON_Object* data = nullptr) 
 	{
 		return true; 
@@ -52,7 +98,12 @@ public:
 		return true; 
 	}
 
-	virtual void OnCollision(PhysBody3D* body1, PhysBody3D* body2)
+	// Every contact begin/persist/end of the last physics step, see AddContactListener
+	virtual void OnContacts(const ContactEvent* events, uint count)
+	{}
+
+	// Sent to a body's collision listeners right before it is recycled
+	virtual void OnBodyRemoved(PhysBody3D* body)
 	{}
 
 };
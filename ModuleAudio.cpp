@@ -9,6 +9,7 @@
 ModuleAudio::ModuleAudio(Application* app, bool start_enabled) : Module(app, start_enabled), music(NULL)
 {
 	name = "audio";
+	memoryTag = Mem_Audio;
 }
 
 // Destructor
@@ -65,14 +66,12 @@ bool ModuleAudio::CleanUp(JSON_Object* data)
 		Mix_FreeMusic(music);
 	}
 
-	p2List_item<Mix_Chunk*>* item;
-
-	for(item = fx.getFirst(); item != NULL; item = item->next)
+	for(unsigned int i = 0; i < fx.Count(); ++i)
 	{
-		Mix_FreeChunk(item->data);
+		Mix_FreeChunk(fx[i]);
 	}
 
-	fx.clear();
+	fx.Clear();
 	Mix_CloseAudio();
 	Mix_Quit();
 	SDL_QuitSubSystem(SDL_INIT_AUDIO);
@@ -148,8 +147,8 @@ unsigned int ModuleAudio::LoadFx(const char* path)
 	}
 	else
 	{
-		fx.add(chunk);
-		ret = fx.count();
+		fx.PushBack(chunk);
+		ret = fx.Count();
 	}
 
 	return ret;
@@ -160,11 +159,9 @@ bool ModuleAudio::PlayFx(unsigned int id, int repeat)
 {
 	bool ret = false;
 
-	Mix_Chunk* chunk = NULL;
-	
-	if(fx.at(id-1, chunk) == true)
+	if(id > 0 && id <= fx.Count())
 	{
-		Mix_PlayChannel(-1, chunk, repeat);
+		Mix_PlayChannel(-1, fx[id - 1], repeat);
 		ret = true;
 	}
 
@@ -3,6 +3,7 @@
 
 #include "Module.h"
 #include "SDL_mixer\include\SDL_mixer.h"
+#include "p2SmallArray.h"
 
 #define DEFAULT_MUSIC_FADE_TIME 2.0f
 
@@ -28,7 +29,7 @@ public:
 private:
 
 	Mix_Music*			music;
-	p2List<Mix_Chunk*>	fx;
+	p2SmallArray<Mix_Chunk*>	fx;
 };
 
 #endif // __ModuleAudio_H__
\ No newline at end of file
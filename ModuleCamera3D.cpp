@@ -3,9 +3,15 @@
 #include "Brofiler-1.1.2\Brofiler.h"
 #include "PhysBody3D.h"
 #include "ModuleCamera3D.h"
+#include "MathGeo\Geometry\Frustum.h"
+#include "MathGeo\Geometry\Plane.h"
 
 ModuleCamera3D::ModuleCamera3D(Application* app, bool start_enabled) : Module(app, start_enabled)
 {
+	name = "camera";
+
+	aspectRatio = (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT;
+
 	CalculateViewMatrix();
 
 	X = vec3(1.0f, 0.0f, 0.0f);
@@ -19,6 +25,12 @@ ModuleCamera3D::ModuleCamera3D(Application* app, bool start_enabled) : Module(ap
 ModuleCamera3D::~ModuleCamera3D()
 {}
 
+// -----------------------------------------------------------------
+void ModuleCamera3D::DeclareDependencies()
+{
+	Reads(App->input);
+}
+
 // -----------------------------------------------------------------
 bool ModuleCamera3D::Start()
 {
@@ -153,6 +165,44 @@ float* ModuleCamera3D::GetViewMatrix()
 	return &ViewMatrix;
 }
 
+// -----------------------------------------------------------------
+void ModuleCamera3D::SetAspectRatio(float aspectRatio)
+{
+	this->aspectRatio = aspectRatio;
+}
+
+// -----------------------------------------------------------------
+// Same view and projection the renderer uploads, the camera looks down -Z
+math::Frustum ModuleCamera3D::GetFrustum() const
+{
+	math::Frustum frustum;
+	frustum.type = math::PerspectiveFrustum;
+	frustum.pos = math::float3(Position.x, Position.y, Position.z);
+	frustum.front = math::float3(-Z.x, -Z.y, -Z.z);
+	frustum.up = math::float3(Y.x, Y.y, Y.z);
+	frustum.nearPlaneDistance = CAMERA_NEAR;
+	frustum.farPlaneDistance = CAMERA_FAR;
+	frustum.verticalFov = CAMERA_FOV * DEGTORAD;
+	frustum.horizontalFov = 2.0f * atanf(tanf(frustum.verticalFov * 0.5f) * aspectRatio);
+
+	return frustum;
+}
+
+// -----------------------------------------------------------------
+void ModuleCamera3D::GetFrustumPlanes(float planes[6][4]) const
+{
+	math::Plane frustumPlanes[6];
+	GetFrustum().GetPlanes(frustumPlanes);
+
+	for (uint i = 0; i < 6; ++i)
+	{
+		planes[i][0] = frustumPlanes[i].normal.x;
+		planes[i][1] = frustumPlanes[i].normal.y;
+		planes[i][2] = frustumPlanes[i].normal.z;
+		planes[i][3] = frustumPlanes[i].d;
+	}
+}
+
 // -----------------------------------------------------------------
 void ModuleCamera3D::CalculateViewMatrix()
 {
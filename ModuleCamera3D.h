@@ -5,12 +5,22 @@
 #include "Globals.h"
 #include "glmath.h"
 
+#define CAMERA_FOV 60.0f
+#define CAMERA_NEAR 0.125f
+#define CAMERA_FAR 512.0f
+
+namespace math
+{
+	class Frustum;
+}
+
 class ModuleCamera3D : public Module
 {
 public:
 	ModuleCamera3D(Application* app, bool start_enabled = true);
 	~ModuleCamera3D();
 
+	void DeclareDependencies();
 	bool Start();
 	update_status Update(float dt);
 	bool CleanUp(JSON_Object* data = nullptr);
@@ -20,6 +30,11 @@ public:
 	void Move(const vec3 &Movement);
 	float* GetViewMatrix();
 
+	void SetAspectRatio(float aspectRatio);
+	math::Frustum GetFrustum() const;
+	// Outward normal and distance of near, far, left, right, top, bottom
+	void GetFrustumPlanes(float planes[6][4]) const;
+
 private:
 
 	void CalculateViewMatrix();
@@ -31,6 +46,7 @@ public:
 private:
 
 	mat4x4 ViewMatrix, ViewMatrixInverse;
+	float aspectRatio;
 };
 
 #endif //__ModuleCamera3D_H__
\ No newline at end of file
@@ -33,11 +33,25 @@ static void ShowHelpMarker(const char* desc)
 
 ModuleImGui::ModuleImGui(Application* app, bool start_enabled) : Module(app, start_enabled)
 {
+	name = "imgui";
+	memoryTag = Mem_UI;
 }
 
 ModuleImGui::~ModuleImGui()
 {}
 
+// Update ordering against other modules
+void ModuleImGui::DeclareDependencies()
+{
+	RequireMainThread();
+	Reads(App->input);
+	Writes(App->window);
+	Writes(App->renderer3D);
+	Writes(App->physics);
+	Writes(App->sceneEditor);
+	Writes(App->audio);
+}
+
 //Load assets
 bool ModuleImGui::Start()
 {
@@ -51,6 +65,8 @@ bool ModuleImGui::Start()
 	openMenuWindow = false;
 	openConsoleWindow = false;
 	openConfigurationWindow = false;
+	openPhysicsProfilerWindow = false;
+	openMemoryWindow = false;
 	openMathPlaygroundWindow = false;
 	openAboutWindow = false;
 
@@ -107,6 +123,16 @@ update_status ModuleImGui::Update(float dt)
 				openConfigurationWindow = !openConfigurationWindow;
 				configurationActive = !configurationActive;
 			}
+			if (ImGui::MenuItem("Physics Profiler"))
+			{
+				openPhysicsProfilerWindow = !openPhysicsProfilerWindow;
+				physicsProfilerActive = !physicsProfilerActive;
+			}
+			if (ImGui::MenuItem("Memory"))
+			{
+				openMemoryWindow = !openMemoryWindow;
+				memoryActive = !memoryActive;
+			}
 
 			ImGui::EndMenu();
 		}
@@ -159,6 +185,14 @@ update_status ModuleImGui::Update(float dt)
 	{
 		ShowConfigurationWindow();
 	}
+	if (physicsProfilerActive)
+	{
+		ShowPhysicsProfilerWindow();
+	}
+	if (memoryActive)
+	{
+		ShowMemoryWindow();
+	}
 	if (aboutActive)
 	{
 		ShowAboutWindow();
@@ -211,6 +245,14 @@ void ModuleImGui::ShowDebugWindow(bool* p_open)
 		{
 			configurationActive = !configurationActive;
 		}
+		if (ImGui::Checkbox("Show Physics Profiler", &openPhysicsProfilerWindow))
+		{
+			physicsProfilerActive = !physicsProfilerActive;
+		}
+		if (ImGui::Checkbox("Show Memory", &openMemoryWindow))
+		{
+			memoryActive = !memoryActive;
+		}
 		if (ImGui::Checkbox("Show About..", &openAboutWindow))
 		{
 			aboutActive = !aboutActive;
@@ -470,6 +512,38 @@ void ModuleImGui::ShowConfigurationWindow(bool* p_open)
 		ImGui::PlotHistogram("##framerate", &FPSData[0], FPSData.size(), 0, title, 0.0f, 100.0f, ImVec2(310, 100));
 		sprintf_s(title, 25, "Milliseconds %0.1f", MsData[MsData.size() - 1]);
 		ImGui::PlotHistogram("##milliseconds", &MsData[0], MsData.size(), 0, title, 0.0f, 40.0f, ImVec2(310, 100));
+
+		const FramePacing& pacing = App->GetFramePacing();
+
+		ImGui::Text("Mean frame time:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%.3f ms", pacing.meanMs);
+
+		ImGui::Text("Frame time variance:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%.3f ms^2", pacing.variance);
+
+		ImGui::Text("Missed vsyncs:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%u", pacing.missedVsyncs);
+
+		const FrameArenaStats& arena = App->frameArena.GetStats();
+
+		ImGui::Separator();
+		ImGui::Text("Frame arena");
+		ImGui::ProgressBar(arena.capacity > 0 ? (float)arena.used / arena.capacity : 0.0f, ImVec2(310, 0), App->frameArena.Printf("%.1f / %u KB", arena.used / 1024.0f, arena.capacity / 1024));
+
+		ImGui::Text("High water mark:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%.1f KB", arena.highWater / 1024.0f);
+
+		ImGui::Text("Overflow:");
+		ImGui::SameLine();
+		ImGui::TextColored(arena.overflowBytes > 0 ? ImVec4(255, 0, 0, 100) : ImVec4(255, 255, 0, 100), "%.1f KB in %u allocations", arena.overflowBytes / 1024.0f, arena.overflowAllocations);
+
+		ImGui::Text("Frames overflowed:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%u", arena.overflowFrames);
 	}
 	if ((ImGui::CollapsingHeader("Audio")))
 	{
@@ -535,6 +609,26 @@ void ModuleImGui::ShowConfigurationWindow(bool* p_open)
 	{
 		ImGui::Text("Mouse X: %i | Mouse Y: %i", App->input->GetMouseX(), App->input->GetMouseY());
 	}
+	if (ImGui::CollapsingHeader("Physics"))
+	{
+		ImGui::SliderInt("Tick Rate", &App->physics->tickRate, 10, 240);
+		ImGui::SliderInt("Max Substeps", &App->physics->maxSubSteps, 1, 15);
+		ImGui::SliderInt("Narrowphase Threads", &App->physics->threads, 0, App->jobs.GetThreadCount());
+		ImGui::DragFloat("World Extent", &App->physics->worldExtent, 10.0f, 10.0f, 100000.0f);
+		ImGui::DragFloat("Projectile Lifetime", &App->physics->projectileLifetime, 0.5f, 0.5f, 600.0f);
+
+		ImGui::Text("Substeps last frame:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%i", App->physics->GetLastSubSteps());
+
+		ImGui::Text("Bodies:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%u of %u pooled", App->physics->GetBodyCount(), App->physics->GetBodyCapacity());
+
+		ImGui::Text("Collision shapes:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%u shared by %u bodies", App->physics->GetShapeCache().GetShapeCount(), App->physics->GetShapeCache().GetReferenceCount());
+	}
 	if (ImGui::CollapsingHeader("Renderer"))
 	{
 		if (ImGui::Checkbox("Wireframe Mode", &wireframe))
@@ -561,6 +655,34 @@ void ModuleImGui::ShowConfigurationWindow(bool* p_open)
 		{
 			App->renderer3D->SetTexture2D();
 		}
+
+		ImGui::Separator();
+
+		const RenderStats& stats = App->renderer3D->batcher.GetStats();
+
+		ImGui::Text("Instancing:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%s", App->renderer3D->batcher.IsInstanced() ? "On" : "Off");
+
+		ImGui::Text("Draw calls:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%u", stats.drawCalls);
+
+		ImGui::Text("State changes:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%u", stats.stateChanges);
+
+		ImGui::Text("Batches:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%u (%u instances)", stats.batches, stats.instances);
+
+		ImGui::Text("Visible objects:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%u (%u culled)", stats.visible, stats.culled);
+
+		ImGui::Text("Spatial index:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%u objects, height %i", App->sceneEditor->GetObjectCount(), App->sceneEditor->GetSpatialIndex().GetHeight());
 	}
 	if (ImGui::CollapsingHeader("Hardware"))
 	{
@@ -577,6 +699,10 @@ void ModuleImGui::ShowConfigurationWindow(bool* p_open)
 		ImGui::SameLine();
 		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%i (Cache: %iKB)", SDL_GetCPUCount(), SDL_GetCPUCacheLineSize());
 
+		ImGui::Text("Job threads:");
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%u", App->jobs.GetThreadCount());
+
 		ImGui::Text("System RAM:");
 		ImGui::SameLine();
 		ImGui::TextColored(ImVec4(255, 255, 0, 100), "%iGB", SDL_GetSystemRAM() / 1000);
@@ -675,6 +801,133 @@ void ModuleImGui::ShowConfigurationWindow(bool* p_open)
 	ImGui::End();
 }
 
+void ModuleImGui::ShowPhysicsProfilerWindow(bool* p_open)
+{
+	if (!ImGui::Begin("Physics Profiler", p_open))
+	{
+		// Early out if the window is collapsed, as an optimization.
+		ImGui::End();
+		return;
+	}
+
+	ImGui::PushItemWidth(-140);
+
+	PhysicsProfiler& profiler = App->physics->GetProfiler();
+	const PhysicsFrameSample& frame = profiler.GetLastFrame();
+	char title[40];
+
+	sprintf_s(title, 40, "Step %.3f ms", frame.totalMs);
+	ImGui::PlotLines("##physicstotal", profiler.GetTotalHistory(), PHYSICS_PROFILE_HISTORY, profiler.GetHistoryOffset(), title, 0.0f, FLT_MAX, ImVec2(310, 60));
+
+	for (uint i = 0; i < PHASE_COUNT; ++i)
+	{
+		PhysicsPhase phase = (PhysicsPhase)i;
+		sprintf_s(title, 40, "%s %.3f ms", PhysicsProfiler::GetPhaseName(phase), frame.phaseMs[i]);
+		ImGui::PushID(i);
+		ImGui::PlotLines("##physicsphase", profiler.GetPhaseHistory(phase), PHYSICS_PROFILE_HISTORY, profiler.GetHistoryOffset(), title, 0.0f, FLT_MAX, ImVec2(310, 40));
+		ImGui::PopID();
+	}
+
+	ImGui::Text("Substeps: %u | Bodies: %u", frame.substeps, frame.bodies);
+	ImGui::Text("Pairs: %u | Manifolds: %u | Contacts: %u", frame.pairs, frame.manifolds, frame.contacts);
+
+	ImGui::Separator();
+
+	bool recording = profiler.IsRecording();
+	if (ImGui::Checkbox("Record Trace", &recording))
+	{
+		profiler.SetRecording(recording);
+	}
+	ImGui::SameLine();
+	ImGui::Text("%u frames", profiler.GetTraceSize());
+
+	if (ImGui::Button("Export CSV"))
+	{
+		if (profiler.SaveCSV(PHYSICS_TRACE_CSV))
+		{
+			AddLogToWindow("Physics trace saved to " PHYSICS_TRACE_CSV);
+		}
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Export JSON"))
+	{
+		if (profiler.SaveJSON(PHYSICS_TRACE_JSON))
+		{
+			AddLogToWindow("Physics trace saved to " PHYSICS_TRACE_JSON);
+		}
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Clear"))
+	{
+		profiler.ClearTrace();
+	}
+
+	ImGui::End();
+}
+
+void ModuleImGui::ShowMemoryWindow(bool* p_open)
+{
+	if (!ImGui::Begin("Memory", p_open))
+	{
+		// Early out if the window is collapsed, as an optimization.
+		ImGui::End();
+		return;
+	}
+
+	ImGui::PushItemWidth(-140);
+
+	if (MEMORY_TRACKING == 0)
+	{
+		ImGui::TextWrapped("Memory tracking is disabled in this build (MEMORY_TRACKING 0), nothing is counted.");
+	}
+
+	char title[40];
+	sprintf_s(title, 40, "Allocations %u / frame", MemoryTracker::GetLastFrameAllocations());
+	ImGui::PlotHistogram("##frameallocations", MemoryTracker::GetFrameHistory(), MEMORY_FRAME_HISTORY, MemoryTracker::GetFrameHistoryOffset(), title, 0.0f, FLT_MAX, ImVec2(310, 60));
+
+	ImGui::Text("In use: %.1f KB | Peak: %.1f KB", MemoryTracker::GetTotalBytes() / 1024.0f, MemoryTracker::GetPeakBytes() / 1024.0f);
+	ImGui::Text("Worst frame: %u allocations", MemoryTracker::GetMaxFrameAllocations());
+
+	uint flagged = MemoryTracker::GetFlaggedFrames();
+	ImGui::Text("Frames over %u allocations:", MemoryTracker::GetFrameBudget());
+	ImGui::SameLine();
+	ImGui::TextColored(flagged > 0 ? ImVec4(255, 0, 0, 100) : ImVec4(255, 255, 0, 100), "%u of %u", flagged, MemoryTracker::GetFrameCount());
+
+	ImGui::Separator();
+	ImGui::Columns(5, "memorytags");
+	ImGui::Text("Tag"); ImGui::NextColumn();
+	ImGui::Text("KB"); ImGui::NextColumn();
+	ImGui::Text("Peak KB"); ImGui::NextColumn();
+	ImGui::Text("Blocks"); ImGui::NextColumn();
+	ImGui::Text("Last frame"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (uint i = 0; i < Mem_TagCount; ++i)
+	{
+		MemoryTagStats stats;
+		MemoryTracker::GetTagStats((MemoryTag)i, stats);
+
+		ImGui::Text("%s", MemoryTracker::GetTagName((MemoryTag)i)); ImGui::NextColumn();
+		ImGui::Text("%.1f", stats.bytes / 1024.0f); ImGui::NextColumn();
+		ImGui::Text("%.1f", stats.peakBytes / 1024.0f); ImGui::NextColumn();
+		ImGui::Text("%u", (uint)stats.allocations); ImGui::NextColumn();
+		ImGui::Text("%u", stats.frameAllocations); ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+
+	ImGui::Separator();
+
+	if (ImGui::Button("Export JSON"))
+	{
+		if (MemoryTracker::SaveReport(MEMORY_REPORT))
+		{
+			AddLogToWindow("Memory report saved to " MEMORY_REPORT);
+		}
+	}
+
+	ImGui::End();
+}
+
 void ModuleImGui::ShowAboutWindow(bool* p_open)
 {
 	// Demonstrate the various window flags. Typically you would just use the default.
@@ -744,7 +997,7 @@ void ModuleImGui::CycleFPSAndMsData(float fps, float ms)
 	//FPS
 	if (FPSData.size() >= MAX_FPS_MS_COUNT)
 	{
-		for (int i = 0; i < MAX_FPS_MS_COUNT - 2; i++)
+		for (int i = 0; i < MAX_FPS_MS_COUNT - 1; i++)
 		{
 			FPSData[i] = FPSData[i + 1];
 		}
@@ -758,7 +1011,7 @@ void ModuleImGui::CycleFPSAndMsData(float fps, float ms)
 	//MS
 	if (MsData.size() >= MAX_FPS_MS_COUNT)
 	{
-		for (int i = 0; i < MAX_FPS_MS_COUNT - 2; i++)
+		for (int i = 0; i < MAX_FPS_MS_COUNT - 1; i++)
 		{
 			MsData[i] = MsData[i + 1];
 		}
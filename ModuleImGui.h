@@ -13,6 +13,7 @@ public:
 	ModuleImGui(Application* app, bool start_enabled = true);
 	~ModuleImGui();
 
+	void DeclareDependencies();
 	bool Start();
 	update_status Update(float dt);
 	update_status PreUpdate(float dt);
@@ -27,6 +28,8 @@ private:
 	bool consoleActive = false;
 	bool mathPlaygroundActive = false;
 	bool configurationActive = false;
+	bool physicsProfilerActive = false;
+	bool memoryActive = false;
 	bool aboutActive = false;
 
 	bool closeApp = false;
@@ -53,6 +56,8 @@ public:
 	IMGUI_API void ShowConsoleWindow(bool* p_open = NULL);
 	IMGUI_API void ShowMathWindow(bool* p_open = NULL);
 	IMGUI_API void ShowConfigurationWindow(bool* p_open = NULL);
+	IMGUI_API void ShowPhysicsProfilerWindow(bool* p_open = NULL);
+	IMGUI_API void ShowMemoryWindow(bool* p_open = NULL);
 	IMGUI_API void ShowAboutWindow(bool* p_open = NULL);
 	void AddLogToWindow(std::string toAdd);
 
@@ -64,6 +69,8 @@ private:
 	bool openMenuWindow;
 	bool openConsoleWindow;
 	bool openConfigurationWindow;
+	bool openPhysicsProfilerWindow;
+	bool openMemoryWindow;
 	bool openMathPlaygroundWindow;
 	bool openAboutWindow;
 
@@ -20,6 +20,14 @@ ModuleInput::~ModuleInput()
 	delete[] keyboard;
 }
 
+// Update ordering against other modules
+void ModuleInput::DeclareDependencies()
+{
+	// SDL events must be pumped from the thread that owns the window
+	RequireMainThread();
+	Writes(App->renderer3D);
+}
+
 // Called before render is available
 bool ModuleInput::Init(JSON_Object* data)
 {
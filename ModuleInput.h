@@ -21,6 +21,7 @@ public:
 	ModuleInput(Application* app, bool start_enabled = true);
 	~ModuleInput();
 
+	void DeclareDependencies();
 	bool Init(JSON_Object* data = nullptr);
 	update_status PreUpdate(float dt);
 	bool CleanUp(JSON_Object* data = nullptr);
@@ -4,6 +4,8 @@
 #include "ModulePhysics3D.h"
 #include "PhysBody3D.h"
 #include "Primitive.h"
+#include "Glew\include\glew.h"
+#include <algorithm>
 
 #ifdef _DEBUG
 	#pragma comment (lib, "Bullet/libx86/BulletDynamics_debug.lib")
@@ -18,14 +20,23 @@
 ModulePhysics3D::ModulePhysics3D(Application* app, bool start_enabled) : Module(app, start_enabled)
 {
 	debug = false;
-
-	collision_conf = new btDefaultCollisionConfiguration();
-	dispatcher = new btCollisionDispatcher(collision_conf);
+	tickRate = PHYSICS_TICK_RATE;
+	maxSubSteps = PHYSICS_MAX_SUBSTEPS;
+	threads = 0;
+	lastSubSteps = 0;
+	worldExtent = PHYSICS_WORLD_EXTENT;
+	projectileLifetime = PHYSICS_PROJECTILE_LIFETIME;
+	simulationTime = 0.0f;
+	groundShape = nullptr;
+
+	collision_conf = new ParallelCollisionConfiguration();
+	dispatcher = new ParallelDispatcher(collision_conf, &app->jobs);
 	broad_phase = new btDbvtBroadphase();
 	solver = new btSequentialImpulseConstraintSolver();
-	debug_draw = new DebugDrawer();
+	debug_draw = new DebugDrawer(&app->frameArena);
 
 	name = "physics";
+	memoryTag = Mem_Physics;
 }
 
 // Destructor
@@ -38,6 +49,15 @@ ModulePhysics3D::~ModulePhysics3D()
 	delete collision_conf;
 }
 
+// Update ordering against other modules
+void ModulePhysics3D::DeclareDependencies()
+{
+	// Debug draw issues GL calls
+	RequireMainThread(STAGE_UPDATE);
+	Reads(App->input);
+	Reads(App->camera);
+}
+
 // Render not available yet----------------------------------
 bool ModulePhysics3D::Init(JSON_Object* data)
 {
@@ -47,6 +67,43 @@ bool ModulePhysics3D::Init(JSON_Object* data)
 	App->imGui->AddLogToWindow("Creating 3D Physics simulation");
 	bool ret = true;
 
+	if (data != nullptr)
+	{
+		if (json_object_has_value(data, "tickRate"))
+		{
+			tickRate = (int)json_object_dotget_number(data, "tickRate");
+		}
+		if (json_object_has_value(data, "maxSubSteps"))
+		{
+			maxSubSteps = (int)json_object_dotget_number(data, "maxSubSteps");
+		}
+		if (json_object_has_value(data, "threads"))
+		{
+			threads = (int)json_object_dotget_number(data, "threads");
+		}
+		if (json_object_has_value(data, "worldExtent"))
+		{
+			worldExtent = (float)json_object_dotget_number(data, "worldExtent");
+		}
+		if (json_object_has_value(data, "projectileLifetime"))
+		{
+			projectileLifetime = (float)json_object_dotget_number(data, "projectileLifetime");
+		}
+	}
+
+	if (tickRate <= 0)
+	{
+		tickRate = PHYSICS_TICK_RATE;
+	}
+	if (maxSubSteps <= 0)
+	{
+		maxSubSteps = PHYSICS_MAX_SUBSTEPS;
+	}
+	if (threads < 0)
+	{
+		threads = 0;
+	}
+
 	return ret;
 }
 
@@ -57,19 +114,25 @@ bool ModulePhysics3D::Start()
 	LOG("Creating Physics environment");
 	App->imGui->AddLogToWindow("Creating Physics environment");
 
-	world = new btDiscreteDynamicsWorld(dispatcher, broad_phase, solver, collision_conf);
+	world = new ProfiledDynamicsWorld(dispatcher, broad_phase, solver, collision_conf, &profiler);
 	world->setDebugDrawer(debug_draw);
 	world->setGravity(GRAVITY);
+	world->setInternalTickCallback(&ModulePhysics3D::OnStepDone, this);
 	vehicle_raycaster = new btDefaultVehicleRaycaster(world);
 
+	contactEvents.reserve(PHYSICS_CONTACT_RESERVE);
+	contactSteps.reserve(PHYSICS_MAX_SUBSTEPS);
+	currentPairs.reserve(PHYSICS_CONTACT_RESERVE);
+	previousPairs.reserve(PHYSICS_CONTACT_RESERVE);
+
 	// Big plane as ground
 	{
-		btCollisionShape* colShape = new btStaticPlaneShape(btVector3(0, 1, 0), 0);
+		groundShape = new btStaticPlaneShape(btVector3(0, 1, 0), 0);
 
-		btDefaultMotionState* myMotionState = new btDefaultMotionState();
-		btRigidBody::btRigidBodyConstructionInfo rbInfo(0.0f, myMotionState, colShape);
+		SyncMotionState* myMotionState = motions.Acquire(btTransform::getIdentity(), &movedBodies);
+		btRigidBody::btRigidBodyConstructionInfo rbInfo(0.0f, myMotionState, groundShape);
 
-		btRigidBody* body = new btRigidBody(rbInfo);
+		btRigidBody* body = rigidBodies.Acquire(rbInfo);
 		world->addRigidBody(body);
 	}
 
@@ -79,39 +142,35 @@ bool ModulePhysics3D::Start()
 // ---------------------------------------------------------
 update_status ModulePhysics3D::PreUpdate(float dt)
 {
-	world->stepSimulation(dt, 15);
+	Timer stepTimer;
+	profiler.BeginFrame();
 
-	int numManifolds = world->getDispatcher()->getNumManifolds();
-	for(int i = 0; i<numManifolds; i++)
-	{
-		btPersistentManifold* contactManifold = world->getDispatcher()->getManifoldByIndexInternal(i);
-		btCollisionObject* obA = (btCollisionObject*)(contactManifold->getBody0());
-		btCollisionObject* obB = (btCollisionObject*)(contactManifold->getBody1());
+	contactEvents.clear();
+	contactSteps.clear();
 
-		int numContacts = contactManifold->getNumContacts();
-		if(numContacts > 0)
-		{
-			PhysBody3D* pbodyA = (PhysBody3D*)obA->getUserPointer();
-			PhysBody3D* pbodyB = (PhysBody3D*)obB->getUserPointer();
+	// Safe point: nothing inside Bullet holds on to the bodies between steps
+	Timer phaseTimer;
+	FlushRemovals();
+	uint removalBatches = contactSteps.size();
+	profiler.AddPhase(Phase_Listeners, phaseTimer.ReadMs());
 
-			if(pbodyA && pbodyB)
-			{
-				p2List_item<Module*>* item = pbodyA->collision_listeners.getFirst();
-				while(item)
-				{
-					item->data->OnCollision(pbodyA, pbodyB);
-					item = item->next;
-				}
+	// Bullet accumulates dt and runs whole steps of 1 / tickRate, at most maxSubSteps
+	// of them, dropping the excess time. Motion states receive transforms interpolated
+	// between the last two steps with the leftover time.
+	// Contacts are collected by OnStepDone, a frame without steps has no events
+	movedBodies.clear();
+	dispatcher->SetThreadCount(threads);
+	lastSubSteps = world->stepSimulation(dt, maxSubSteps, 1.0f / tickRate);
+	simulationTime += lastSubSteps / (float)tickRate;
 
-				item = pbodyB->collision_listeners.getFirst();
-				while(item)
-				{
-					item->data->OnCollision(pbodyB, pbodyA);
-					item = item->next;
-				}
-			}
-		}
-	}
+	phaseTimer.Start();
+	QueueOutOfBounds();
+	QueueExpired();
+
+	DispatchContacts(removalBatches);
+	profiler.AddPhase(Phase_Listeners, phaseTimer.ReadMs());
+
+	profiler.EndFrame(stepTimer.ReadMs(), lastSubSteps, bodies.Count(), broad_phase->getOverlappingPairCache()->getNumOverlappingPairs(), dispatcher->getNumManifolds(), contactEvents.size());
 
 	return UPDATE_CONTINUE;
 }
@@ -125,14 +184,14 @@ update_status ModulePhysics3D::Update(float dt)
 
 	if(debug == true)
 	{
+		debug_draw->BeginFrame();
 		world->debugDrawWorld();
+		debug_draw->flushLines();
 
 		// Render vehicles
-		p2List_item<PhysVehicle3D*>* item = vehicles.getFirst();
-		while(item)
+		for(uint i = 0; i < vehicles.Count(); ++i)
 		{
-			//item->data->Render();
-			item = item->next;
+			//vehicles[i]->Render();
 		}
 
 		if(App->input->GetKey(SDL_SCANCODE_1) == KEY_DOWN)
@@ -140,7 +199,9 @@ update_status ModulePhysics3D::Update(float dt)
 			Sphere s(1);
 			s.SetPos(App->camera->Position.x, App->camera->Position.y, App->camera->Position.z);
 			float force = 30.0f;
-			AddBody(s)->Push(-(App->camera->Z.x * force), -(App->camera->Z.y * force), -(App->camera->Z.z * force));
+			PhysBody3D* projectile = AddBody(s);
+			projectile->Push(-(App->camera->Z.x * force), -(App->camera->Z.y * force), -(App->camera->Z.z * force));
+			SetLifetime(projectile, projectileLifetime);
 		}
 	}
 
@@ -166,36 +227,44 @@ bool ModulePhysics3D::CleanUp(JSON_Object* data)
 		world->removeCollisionObject(obj);
 	}
 
-	for(p2List_item<btTypedConstraint*>* item = constraints.getFirst(); item; item = item->next)
+	for(uint i = 0; i < constraints.Count(); ++i)
 	{
-		world->removeConstraint(item->data);
-		delete item->data;
+		world->removeConstraint(constraints[i]);
+		delete constraints[i];
 	}
 	
-	constraints.clear();
-
-	for(p2List_item<btDefaultMotionState*>* item = motions.getFirst(); item; item = item->next)
-		delete item->data;
+	constraints.Clear();
 
-	motions.clear();
+	pendingRemovals.clear();
+	mortalBodies.clear();
+	movedBodies.clear();
+	contactEvents.clear();
+	contactSteps.clear();
+	currentPairs.clear();
+	previousPairs.clear();
 
-	for(p2List_item<btCollisionShape*>* item = shapes.getFirst(); item; item = item->next)
-		delete item->data;
+	bodies.Clear();
+	rigidBodies.Clear();
+	motions.Clear();
+	shapeCache.Clear();
 
-	shapes.clear();
+	for(uint i = 0; i < vehicles.Count(); ++i)
+		delete vehicles[i];
 
-	for(p2List_item<PhysBody3D*>* item = bodies.getFirst(); item; item = item->next)
-		delete item->data;
-
-	bodies.clear();
-
-	for(p2List_item<PhysVehicle3D*>* item = vehicles.getFirst(); item; item = item->next)
-		delete item->data;
-
-	vehicles.clear();
+	vehicles.Clear();
 
 	delete vehicle_raycaster;
 	delete world;
+	delete groundShape;
+	groundShape = nullptr;
+
+	JSON_Object* physicsData = json_object_dotget_object(data, name.c_str());
+
+	json_object_dotset_number(physicsData, "tickRate", tickRate);
+	json_object_dotset_number(physicsData, "maxSubSteps", maxSubSteps);
+	json_object_dotset_number(physicsData, "threads", threads);
+	json_object_dotset_number(physicsData, "worldExtent", worldExtent);
+	json_object_dotset_number(physicsData, "projectileLifetime", projectileLifetime);
 
 	return true;
 }
@@ -203,80 +272,295 @@ bool ModulePhysics3D::CleanUp(JSON_Object* data)
 // ---------------------------------------------------------
 PhysBody3D* ModulePhysics3D::AddBody(const Sphere& sphere, float mass)
 {
-	btCollisionShape* colShape = new btSphereShape(sphere.radius);
-	shapes.add(colShape);
+	return AddBody(shapeCache.AcquireSphere(sphere.radius), sphere.transform, mass);
+}
+
+// ---------------------------------------------------------
+PhysBody3D* ModulePhysics3D::AddBody(const Cube& cube, float mass)
+{
+	return AddBody(shapeCache.AcquireBox(vec3(cube.size.x*0.5f, cube.size.y*0.5f, cube.size.z*0.5f)), cube.transform, mass);
+}
+
+// ---------------------------------------------------------
+PhysBody3D* ModulePhysics3D::AddBody(const Cylinder& cylinder, float mass)
+{
+	return AddBody(shapeCache.AcquireCylinderX(cylinder.height*0.5f, cylinder.radius), cylinder.transform, mass);
+}
 
+// ---------------------------------------------------------
+// Shape comes from the cache already referenced for this body
+PhysBody3D* ModulePhysics3D::AddBody(btCollisionShape* colShape, const mat4x4& transform, float mass)
+{
 	btTransform startTransform;
-	startTransform.setFromOpenGLMatrix(&sphere.transform);
+	startTransform.setFromOpenGLMatrix(&transform);
 
-	btVector3 localInertia(0, 0, 0);
-	if(mass != 0.f)
-		colShape->calculateLocalInertia(mass, localInertia);
+	vec3 inertia = shapeCache.GetLocalInertia(colShape, mass);
+	btVector3 localInertia(inertia.x, inertia.y, inertia.z);
 
-	btDefaultMotionState* myMotionState = new btDefaultMotionState(startTransform);
-	motions.add(myMotionState);
+	SyncMotionState* myMotionState = motions.Acquire(startTransform, &movedBodies);
 	btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, myMotionState, colShape, localInertia);
 
-	btRigidBody* body = new btRigidBody(rbInfo);
-	PhysBody3D* pbody = new PhysBody3D(body);
+	btRigidBody* body = rigidBodies.Acquire(rbInfo);
+	PhysBody3D* pbody = bodies.Acquire(body);
+	myMotionState->body = pbody;
 
 	world->addRigidBody(body);
-	bodies.add(pbody);
 
 	return pbody;
 }
 
+// ---------------------------------------------------------
+void ModulePhysics3D::RemoveBody(PhysBody3D* body)
+{
+	if (body != nullptr && body->pending_removal == false)
+	{
+		body->pending_removal = true;
+		pendingRemovals.push_back(body);
+	}
+}
 
 // ---------------------------------------------------------
-PhysBody3D* ModulePhysics3D::AddBody(const Cube& cube, float mass)
+void ModulePhysics3D::SetLifetime(PhysBody3D* body, float seconds)
 {
-	btCollisionShape* colShape = new btBoxShape(btVector3(cube.size.x*0.5f, cube.size.y*0.5f, cube.size.z*0.5f));
-	shapes.add(colShape);
+	if (body->expire_time == 0.0f)
+	{
+		mortalBodies.push_back(body);
+	}
+	body->expire_time = simulationTime + seconds;
+}
 
-	btTransform startTransform;
-	startTransform.setFromOpenGLMatrix(&cube.transform);
+// ---------------------------------------------------------
+// Only bodies Bullet moved this step can have left the world
+void ModulePhysics3D::QueueOutOfBounds()
+{
+	for (uint i = 0; i < movedBodies.size(); ++i)
+	{
+		const float* position = &movedBodies[i].transform[12];
+
+		if (fabsf(position[0]) > worldExtent || fabsf(position[1]) > worldExtent || fabsf(position[2]) > worldExtent)
+		{
+			RemoveBody(movedBodies[i].body);
+		}
+	}
+}
 
-	btVector3 localInertia(0, 0, 0);
-	if(mass != 0.f)
-		colShape->calculateLocalInertia(mass, localInertia);
+// ---------------------------------------------------------
+void ModulePhysics3D::QueueExpired()
+{
+	for (uint i = 0; i < mortalBodies.size();)
+	{
+		PhysBody3D* body = mortalBodies[i];
 
-	btDefaultMotionState* myMotionState = new btDefaultMotionState(startTransform);
-	motions.add(myMotionState);
-	btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, myMotionState, colShape, localInertia);
+		if (body->pending_removal == true || simulationTime >= body->expire_time)
+		{
+			RemoveBody(body);
+			mortalBodies[i] = mortalBodies.back();
+			mortalBodies.pop_back();
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+// ---------------------------------------------------------
+void ModulePhysics3D::FlushRemovals()
+{
+	if (pendingRemovals.empty())
+	{
+		return;
+	}
 
-	btRigidBody* body = new btRigidBody(rbInfo);
-	PhysBody3D* pbody = new PhysBody3D(body);
+	// End the contacts of the recycled bodies while they are still valid, whatever
+	// they touched would never see an end otherwise. The pool hands these addresses
+	// out again, so the pairs can't stay in the previous set either. Bodies listeners
+	// remove from here on wait for the next frame and get their ends then
+	uint count = pendingRemovals.size();
 
-	world->addRigidBody(body);
-	bodies.add(pbody);
+	for (uint i = 0; i < count; ++i)
+	{
+		PhysBody3D* pbody = pendingRemovals[i];
 
-	return pbody;
+		for (uint p = 0; p < previousPairs.size();)
+		{
+			if (previousPairs[p].bodyA == pbody || previousPairs[p].bodyB == pbody)
+			{
+				ContactEvent contact;
+				contact.type = Contact_End;
+				contact.bodyA = previousPairs[p].bodyA;
+				contact.bodyB = previousPairs[p].bodyB;
+				contactEvents.push_back(contact);
+
+				previousPairs.erase(previousPairs.begin() + p);
+			}
+			else
+			{
+				++p;
+			}
+		}
+	}
+
+	contactSteps.push_back(contactEvents.size());
+	DispatchContacts(contactSteps.size() - 1);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		PhysBody3D* pbody = pendingRemovals[i];
+
+		for (uint l = 0; l < pbody->collision_listeners.Count(); ++l)
+		{
+			pbody->collision_listeners[l]->OnBodyRemoved(pbody);
+		}
+
+		if (pbody->expire_time != 0.0f)
+		{
+			for (uint m = 0; m < mortalBodies.size(); ++m)
+			{
+				if (mortalBodies[m] == pbody)
+				{
+					mortalBodies[m] = mortalBodies.back();
+					mortalBodies.pop_back();
+					break;
+				}
+			}
+		}
+
+		btRigidBody* body = pbody->body;
+		world->removeRigidBody(body);
+
+		shapeCache.Release(body->getCollisionShape());
+		motions.Release((SyncMotionState*)body->getMotionState());
+		rigidBodies.Release(body);
+		bodies.Release(pbody);
+	}
+
+	pendingRemovals.erase(pendingRemovals.begin(), pendingRemovals.begin() + count);
 }
 
 // ---------------------------------------------------------
-PhysBody3D* ModulePhysics3D::AddBody(const Cylinder& cylinder, float mass)
+void ModulePhysics3D::AddContactListener(Module* listener)
 {
-	btCollisionShape* colShape = new btCylinderShapeX(btVector3(cylinder.height*0.5f, cylinder.radius, 0.0f));
-	shapes.add(colShape);
+	if (std::find(contactListeners.begin(), contactListeners.end(), listener) == contactListeners.end())
+	{
+		contactListeners.push_back(listener);
+	}
+}
 
-	btTransform startTransform;
-	startTransform.setFromOpenGLMatrix(&cylinder.transform);
+// ---------------------------------------------------------
+void ModulePhysics3D::RemoveContactListener(Module* listener)
+{
+	std::vector<Module*>::iterator found = std::find(contactListeners.begin(), contactListeners.end(), listener);
+	if (found != contactListeners.end())
+	{
+		contactListeners.erase(found);
+	}
+}
 
-	btVector3 localInertia(0, 0, 0);
-	if(mass != 0.f)
-		colShape->calculateLocalInertia(mass, localInertia);
+// ---------------------------------------------------------
+void ModulePhysics3D::OnStepDone(btDynamicsWorld* world, btScalar timeStep)
+{
+	ModulePhysics3D* physics = (ModulePhysics3D*)world->getWorldUserInfo();
 
-	btDefaultMotionState* myMotionState = new btDefaultMotionState(startTransform);
-	motions.add(myMotionState);
-	btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, myMotionState, colShape, localInertia);
+	Timer timer;
+	physics->CollectContacts();
+	physics->profiler.AddPhase(Phase_Listeners, timer.ReadMs());
+}
 
-	btRigidBody* body = new btRigidBody(rbInfo);
-	PhysBody3D* pbody = new PhysBody3D(body);
+// ---------------------------------------------------------
+// Touching pairs this step, sorted, merged against last step's to classify them.
+// The step's events are appended to the ones of earlier steps this frame
+void ModulePhysics3D::CollectContacts()
+{
+	currentPairs.clear();
 
-	world->addRigidBody(body);
-	bodies.add(pbody);
+	int numManifolds = world->getDispatcher()->getNumManifolds();
+	for(int i = 0; i<numManifolds; i++)
+	{
+		btPersistentManifold* contactManifold = world->getDispatcher()->getManifoldByIndexInternal(i);
+		if(contactManifold->getNumContacts() == 0)
+		{
+			continue;
+		}
 
-	return pbody;
+		PhysBody3D* pbodyA = (PhysBody3D*)contactManifold->getBody0()->getUserPointer();
+		PhysBody3D* pbodyB = (PhysBody3D*)contactManifold->getBody1()->getUserPointer();
+
+		if(pbodyA && pbodyB)
+		{
+			ContactPair pair;
+			pair.bodyA = pbodyA < pbodyB ? pbodyA : pbodyB;
+			pair.bodyB = pbodyA < pbodyB ? pbodyB : pbodyA;
+			currentPairs.push_back(pair);
+		}
+	}
+
+	std::sort(currentPairs.begin(), currentPairs.end());
+	currentPairs.erase(std::unique(currentPairs.begin(), currentPairs.end()), currentPairs.end());
+
+	uint current = 0;
+	uint previous = 0;
+	while (current < currentPairs.size() || previous < previousPairs.size())
+	{
+		ContactEvent contact;
+
+		if (previous == previousPairs.size() || (current < currentPairs.size() && currentPairs[current] < previousPairs[previous]))
+		{
+			contact.type = Contact_Begin;
+			contact.bodyA = currentPairs[current].bodyA;
+			contact.bodyB = currentPairs[current].bodyB;
+			++current;
+		}
+		else if (current == currentPairs.size() || previousPairs[previous] < currentPairs[current])
+		{
+			contact.type = Contact_End;
+			contact.bodyA = previousPairs[previous].bodyA;
+			contact.bodyB = previousPairs[previous].bodyB;
+			++previous;
+		}
+		else
+		{
+			contact.type = Contact_Persist;
+			contact.bodyA = currentPairs[current].bodyA;
+			contact.bodyB = currentPairs[current].bodyB;
+			++current;
+			++previous;
+		}
+
+		contactEvents.push_back(contact);
+	}
+
+	contactSteps.push_back(contactEvents.size());
+	currentPairs.swap(previousPairs);
+}
+
+// ---------------------------------------------------------
+// After stepSimulation, so listeners may add bodies while nothing is mid-step.
+// Delivers the batches in contactSteps from firstBatch on
+void ModulePhysics3D::DispatchContacts(uint firstBatch)
+{
+	uint begin = firstBatch > 0 ? contactSteps[firstBatch - 1] : 0;
+
+	for (uint s = firstBatch; s < contactSteps.size(); ++s)
+	{
+		uint end = contactSteps[s];
+
+		if (end > begin)
+		{
+			for (uint i = 0; i < contactListeners.size(); ++i)
+			{
+				contactListeners[i]->OnContacts(&contactEvents[begin], end - begin);
+			}
+		}
+
+		begin = end;
+	}
+}
+
+// ---------------------------------------------------------
+const std::vector<ContactEvent>& ModulePhysics3D::GetContactEvents() const
+{
+	return contactEvents;
 }
 
 // ---------------------------------------------------------
@@ -288,7 +572,7 @@ void ModulePhysics3D::AddConstraintP2P(PhysBody3D& bodyA, PhysBody3D& bodyB, con
 		btVector3(anchorA.x, anchorA.y, anchorA.z), 
 		btVector3(anchorB.x, anchorB.y, anchorB.z));
 	world->addConstraint(p2p);
-	constraints.add(p2p);
+	constraints.PushBack(p2p);
 	p2p->setDbgDrawSize(2.0f);
 }
 
@@ -303,24 +587,184 @@ void ModulePhysics3D::AddConstraintHinge(PhysBody3D& bodyA, PhysBody3D& bodyB, c
 		btVector3(axisB.x, axisB.y, axisB.z));
 
 	world->addConstraint(hinge, disable_collision);
-	constraints.add(hinge);
+	constraints.PushBack(hinge);
 	hinge->setDbgDrawSize(2.0f);
 }
 
+// ---------------------------------------------------------
+int ModulePhysics3D::GetLastSubSteps() const
+{
+	return lastSubSteps;
+}
+
+// ---------------------------------------------------------
+const std::vector<MovedBody>& ModulePhysics3D::GetMovedBodies() const
+{
+	return movedBodies;
+}
+
+// ---------------------------------------------------------
+const ShapeCache& ModulePhysics3D::GetShapeCache() const
+{
+	return shapeCache;
+}
+
+// ---------------------------------------------------------
+PhysicsProfiler& ModulePhysics3D::GetProfiler()
+{
+	return profiler;
+}
+
+// ---------------------------------------------------------
+uint ModulePhysics3D::GetBodyCount() const
+{
+	return bodies.Count();
+}
+
+// ---------------------------------------------------------
+uint ModulePhysics3D::GetBodyCapacity() const
+{
+	return bodies.Capacity();
+}
+
+// =============================================
+// Same sequence as btCollisionWorld, timing broadphase and narrowphase apart
+void ProfiledDynamicsWorld::performDiscreteCollisionDetection()
+{
+	Timer timer;
+	updateAabbs();
+	computeOverlappingPairs();
+	profiler->AddPhase(Phase_Broadphase, timer.ReadMs());
+
+	timer.Start();
+	btDispatcher* dispatcher = getDispatcher();
+	if (dispatcher != nullptr)
+	{
+		dispatcher->dispatchAllCollisionPairs(m_broadphasePairCache->getOverlappingPairCache(), getDispatchInfo(), dispatcher);
+	}
+	profiler->AddPhase(Phase_Narrowphase, timer.ReadMs());
+}
+
+// ---------------------------------------------------------
+void ProfiledDynamicsWorld::predictUnconstraintMotion(btScalar timeStep)
+{
+	Timer timer;
+	btDiscreteDynamicsWorld::predictUnconstraintMotion(timeStep);
+	profiler->AddPhase(Phase_Integration, timer.ReadMs());
+}
+
+// ---------------------------------------------------------
+void ProfiledDynamicsWorld::calculateSimulationIslands()
+{
+	Timer timer;
+	btDiscreteDynamicsWorld::calculateSimulationIslands();
+	profiler->AddPhase(Phase_Solver, timer.ReadMs());
+}
+
+// ---------------------------------------------------------
+void ProfiledDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo)
+{
+	Timer timer;
+	btDiscreteDynamicsWorld::solveConstraints(solverInfo);
+	profiler->AddPhase(Phase_Solver, timer.ReadMs());
+}
+
+// ---------------------------------------------------------
+void ProfiledDynamicsWorld::integrateTransforms(btScalar timeStep)
+{
+	Timer timer;
+	btDiscreteDynamicsWorld::integrateTransforms(timeStep);
+	profiler->AddPhase(Phase_Integration, timer.ReadMs());
+}
+
+// =============================================
+void SyncMotionState::setWorldTransform(const btTransform& centerOfMassWorldTrans)
+{
+	btDefaultMotionState::setWorldTransform(centerOfMassWorldTrans);
+
+	if (body != nullptr)
+	{
+		if (movedIndex >= moved->size() || (*moved)[movedIndex].body != body)
+		{
+			movedIndex = moved->size();
+			moved->push_back(MovedBody());
+			(*moved)[movedIndex].body = body;
+		}
+
+		m_graphicsWorldTrans.getOpenGLMatrix((*moved)[movedIndex].transform);
+	}
+}
+
 // =============================================
 void DebugDrawer::drawLine(const btVector3& from, const btVector3& to, const btVector3& color)
 {
-	line.origin.Set(from.getX(), from.getY(), from.getZ());
-	line.destination.Set(to.getX(), to.getY(), to.getZ());
-	line.color.Set(color.getX(), color.getY(), color.getZ());
-	line.Render();
+	PushVertex(lines, from, color);
+	PushVertex(lines, to, color);
 }
 
 void DebugDrawer::drawContactPoint(const btVector3& PointOnB, const btVector3& normalOnB, btScalar distance, int lifeTime, const btVector3& color)
 {
-	point.transform.translate(PointOnB.getX(), PointOnB.getY(), PointOnB.getZ());
-	point.color.Set(color.getX(), color.getY(), color.getZ());
-	point.Render();
+	PushVertex(points, PointOnB, color);
+}
+
+void DebugDrawer::PushVertex(FrameVertices& vertices, const btVector3& position, const btVector3& color)
+{
+	vertices.PushBack(position.getX());
+	vertices.PushBack(position.getY());
+	vertices.PushBack(position.getZ());
+	vertices.PushBack(color.getX());
+	vertices.PushBack(color.getY());
+	vertices.PushBack(color.getZ());
+}
+
+void DebugDrawer::BeginFrame()
+{
+	// Fresh arrays in whichever arena buffer is current this frame
+	lines = FrameVertices(p2FrameAllocator(arena));
+	points = FrameVertices(p2FrameAllocator(arena));
+
+	lines.Reserve(lastLineFloats);
+	points.Reserve(lastPointFloats);
+}
+
+// Drawn the same frame they are collected, long before the arena reuses their memory
+void DebugDrawer::flushLines()
+{
+	lastLineFloats = lines.Count();
+	lastPointFloats = points.Count();
+
+	if (lines.Count() == 0 && points.Count() == 0)
+	{
+		return;
+	}
+
+	glPushAttrib(GL_ENABLE_BIT | GL_LINE_BIT | GL_POINT_BIT);
+	glDisable(GL_LIGHTING);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+
+	if (lines.Count() > 0)
+	{
+		glLineWidth(2.0f);
+		glVertexPointer(3, GL_FLOAT, 6 * sizeof(float), lines.GetData());
+		glColorPointer(3, GL_FLOAT, 6 * sizeof(float), lines.GetData() + 3);
+		glDrawArrays(GL_LINES, 0, lines.Count() / 6);
+	}
+
+	if (points.Count() > 0)
+	{
+		glPointSize(5.0f);
+		glVertexPointer(3, GL_FLOAT, 6 * sizeof(float), points.GetData());
+		glColorPointer(3, GL_FLOAT, 6 * sizeof(float), points.GetData() + 3);
+		glDrawArrays(GL_POINTS, 0, points.Count() / 6);
+	}
+
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	glPopAttrib();
 }
 
 void DebugDrawer::reportErrorWarning(const char* warningString)
@@ -3,19 +3,97 @@
 
 #include "Module.h"
 #include "Globals.h"
-#include "p2List.h"
+#include "p2SmallArray.h"
 #include "Primitive.h"
+#include "ShapeCache.h"
+#include "ObjectPool.h"
+#include "ParallelDispatcher.h"
+#include "PhysicsProfiler.h"
+#include "FrameArena.h"
+#include "p2DynArray.h"
+#include <vector>
 
 #include "Bullet/include/btBulletDynamicsCommon.h"
 
 // Recommended scale is 1.0f == 1 meter, no less than 0.2 objects
 #define GRAVITY btVector3(0.0f, -20.0f, 0.0f) 
 
+// Default fixed simulation rate and the most fixed steps a single frame may run
+#define PHYSICS_TICK_RATE 60
+#define PHYSICS_MAX_SUBSTEPS 4
+
+// Bodies further than this from the origin on any axis are recycled
+#define PHYSICS_WORLD_EXTENT 1000.0f
+// Seconds a debug projectile lives
+#define PHYSICS_PROJECTILE_LIFETIME 10.0f
+// Contact pairs the event buffers hold before they have to grow
+#define PHYSICS_CONTACT_RESERVE 1024
+
 class DebugDrawer;
 struct PhysBody3D;
 struct PhysVehicle3D;
 struct VehicleInfo;
 
+// Render transform of a body Bullet moved during the last step
+struct MovedBody
+{
+	PhysBody3D* body;
+	float transform[16];
+};
+
+enum ContactEventType
+{
+	Contact_Begin,
+	Contact_Persist,
+	Contact_End
+};
+
+// One touching pair per step, bodyA is the lower address
+struct ContactEvent
+{
+	ContactEventType type;
+	PhysBody3D* bodyA;
+	PhysBody3D* bodyB;
+};
+
+// Bullet only synchronizes the motion states of active bodies, so recording
+// them here gives the moved set without walking every body. It does so after
+// every substep, later ones overwrite the body's entry instead of adding one
+class SyncMotionState : public btDefaultMotionState
+{
+public:
+	SyncMotionState(const btTransform& startTrans, std::vector<MovedBody>* moved) : btDefaultMotionState(startTrans), moved(moved)
+	{}
+
+	void setWorldTransform(const btTransform& centerOfMassWorldTrans);
+
+	PhysBody3D* body = nullptr;
+
+private:
+	std::vector<MovedBody>* moved;
+	// Entry of this body in moved, stale once it points past the end or at another body
+	uint movedIndex = 0;
+};
+
+// Discrete world that reports how long each part of a step takes
+class ProfiledDynamicsWorld : public btDiscreteDynamicsWorld
+{
+public:
+	ProfiledDynamicsWorld(btDispatcher* dispatcher, btBroadphaseInterface* pairCache, btConstraintSolver* constraintSolver, btCollisionConfiguration* collisionConfiguration, PhysicsProfiler* profiler)
+		: btDiscreteDynamicsWorld(dispatcher, pairCache, constraintSolver, collisionConfiguration), profiler(profiler)
+	{}
+
+	void performDiscreteCollisionDetection();
+
+protected:
+	void predictUnconstraintMotion(btScalar timeStep);
+	void calculateSimulationIslands();
+	void solveConstraints(btContactSolverInfo& solverInfo);
+	void integrateTransforms(btScalar timeStep);
+
+private:
+	PhysicsProfiler* profiler;
+};
 
 class ModulePhysics3D : public Module
 {
@@ -23,6 +101,7 @@ public:
 	ModulePhysics3D(Application* app, bool start_enabled = true);
 	~ModulePhysics3D();
 
+	void DeclareDependencies();
 	bool Init(JSON_Object* data = nullptr);
 	bool Start();
 	update_status PreUpdate(float dt);
@@ -34,46 +113,134 @@ public:
 	PhysBody3D* AddBody(const Cube& cube, float mass = 1.0f);
 	PhysBody3D* AddBody(const Cylinder& cylinder, float mass = 1.0f);
 
+	// Deferred to the start of the next step, listeners get OnBodyRemoved then
+	void RemoveBody(PhysBody3D* body);
+	// Recycle the body after the given simulated seconds
+	void SetLifetime(PhysBody3D* body, float seconds);
+
+	// Listeners get one OnContacts call per fixed step the frame ran, once the frame's steps are done
+	void AddContactListener(Module* listener);
+	void RemoveContactListener(Module* listener);
+	// Ends of the bodies recycled this frame, then the events of every fixed step it ran
+	const std::vector<ContactEvent>& GetContactEvents() const;
+
 	void AddConstraintP2P(PhysBody3D& bodyA, PhysBody3D& bodyB, const vec3& anchorA, const vec3& anchorB);
 	void AddConstraintHinge(PhysBody3D& bodyA, PhysBody3D& bodyB, const vec3& anchorA, const vec3& anchorB, const vec3& axisS, const vec3& axisB, bool disable_collision = false);
 
+	int GetLastSubSteps() const;
+	// One entry per body active during the last PreUpdate, sleeping ones never show up
+	const std::vector<MovedBody>& GetMovedBodies() const;
+	const ShapeCache& GetShapeCache() const;
+	PhysicsProfiler& GetProfiler();
+	uint GetBodyCount() const;
+	uint GetBodyCapacity() const;
+
 	bool debug;
+	int tickRate;
+	int maxSubSteps;
+	// Narrowphase threads, 0 or 1 runs it sequentially
+	int threads;
+	float worldExtent;
+	float projectileLifetime;
 
 private:
 
-	
+	PhysBody3D* AddBody(btCollisionShape* colShape, const mat4x4& transform, float mass);
+	void QueueOutOfBounds();
+	void QueueExpired();
+	void FlushRemovals();
+	void CollectContacts();
+	void DispatchContacts(uint firstBatch);
 
-	btDefaultCollisionConfiguration*	collision_conf;
-	btCollisionDispatcher*				dispatcher;
+	// Bullet calls this after each fixed step, stepSimulation may run none or several
+	static void OnStepDone(btDynamicsWorld* world, btScalar timeStep);
+
+private:
+
+	int lastSubSteps;
+	std::vector<MovedBody> movedBodies;
+	std::vector<PhysBody3D*> pendingRemovals;
+	std::vector<PhysBody3D*> mortalBodies;
+	float simulationTime;
+
+	struct ContactPair
+	{
+		PhysBody3D* bodyA;
+		PhysBody3D* bodyB;
+
+		bool operator<(const ContactPair& other) const
+		{
+			return bodyA != other.bodyA ? bodyA < other.bodyA : bodyB < other.bodyB;
+		}
+
+		bool operator==(const ContactPair& other) const
+		{
+			return bodyA == other.bodyA && bodyB == other.bodyB;
+		}
+	};
+
+	std::vector<Module*> contactListeners;
+	std::vector<ContactEvent> contactEvents;
+	// End of each batch (removals, then one per step) in contactEvents
+	std::vector<uint> contactSteps;
+	std::vector<ContactPair> currentPairs;
+	std::vector<ContactPair> previousPairs;
+
+	ParallelCollisionConfiguration*		collision_conf;
+	ParallelDispatcher*					dispatcher;
 	btBroadphaseInterface*				broad_phase;
 	btSequentialImpulseConstraintSolver* solver;
-	btDiscreteDynamicsWorld*			world;
+	ProfiledDynamicsWorld*				world;
 	btDefaultVehicleRaycaster*			vehicle_raycaster;
 	DebugDrawer*						debug_draw;
-
-	p2List<btCollisionShape*> shapes;
-	p2List<PhysBody3D*> bodies;
-	p2List<btDefaultMotionState*> motions;
-	p2List<btTypedConstraint*> constraints;
-	p2List<PhysVehicle3D*> vehicles;
+	// The only shape not owned by the shape cache
+	btCollisionShape*					groundShape;
+
+	ShapeCache shapeCache;
+	PhysicsProfiler profiler;
+	// Everything a body needs lives in pools, spawning one doesn't touch the heap
+	ObjectPool<PhysBody3D> bodies;
+	ObjectPool<btRigidBody> rigidBodies;
+	ObjectPool<SyncMotionState> motions;
+	p2SmallArray<btTypedConstraint*> constraints;
+	p2SmallArray<PhysVehicle3D*> vehicles;
 };
 
+// Collects every line and contact point of a debug draw pass and
+// draws them with one call per primitive type in flushLines.
+// Vertices live in the frame arena and are dropped once drawn.
+// BeginFrame reserves what the last pass needed, so a pass of
+// similar size takes a single arena block instead of one per doubling
 class DebugDrawer : public btIDebugDraw
 {
 public:
-	DebugDrawer() : line(0,0,0)
+	DebugDrawer(FrameArena* arena) : arena(arena), lines(p2FrameAllocator(arena)), points(p2FrameAllocator(arena))
 	{}
 
+	void BeginFrame();
+
 	void drawLine(const btVector3& from, const btVector3& to, const btVector3& color);
 	void drawContactPoint(const btVector3& PointOnB, const btVector3& normalOnB, btScalar distance, int lifeTime, const btVector3& color);
 	void reportErrorWarning(const char* warningString);
 	void draw3dText(const btVector3& location, const char* textString);
 	void setDebugMode(int debugMode);
 	int	 getDebugMode() const;
+	void flushLines();
 
 	DebugDrawModes mode;
-	Line line;
-	Primitive point;
+
+private:
+	typedef p2DynArray<float, p2FrameAllocator> FrameVertices;
+
+	void PushVertex(FrameVertices& vertices, const btVector3& position, const btVector3& color);
+
+	FrameArena* arena;
+
+	// Interleaved position + color
+	FrameVertices lines;
+	FrameVertices points;
+	uint lastLineFloats = 0;
+	uint lastPointFloats = 0;
 };
 
 #endif //__ModulePhysics_H__
\ No newline at end of file
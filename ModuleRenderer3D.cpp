@@ -2,6 +2,7 @@
 #include "Application.h"
 #include "ModuleRenderer3D.h"
 #include "ModuleSceneEditor.h"
+#include "Primitive.h"
 #include "Glew\include\glew.h"
 #include "SDL\include\SDL_opengl.h"
 #include "Brofiler-1.1.2\Brofiler.h"
@@ -15,6 +16,7 @@
 ModuleRenderer3D::ModuleRenderer3D(Application* app, bool start_enabled) : Module(app, start_enabled)
 {
 	name = "renderer";
+	memoryTag = Mem_Render;
 	depthTest = true;
 	cullFace = true;
 	lighting = true;
@@ -26,6 +28,17 @@ ModuleRenderer3D::ModuleRenderer3D(Application* app, bool start_enabled) : Modul
 ModuleRenderer3D::~ModuleRenderer3D()
 {}
 
+// Update ordering against other modules
+void ModuleRenderer3D::DeclareDependencies()
+{
+	RequireMainThread();
+	Reads(App->window);
+	Reads(App->camera);
+	Reads(App->physics);
+	Reads(App->sceneEditor);
+	Reads(App->imGui);
+}
+
 // Called before render is available
 bool ModuleRenderer3D::Init(JSON_Object* data)
 {
@@ -65,6 +78,9 @@ bool ModuleRenderer3D::Init(JSON_Object* data)
 	
 	if(ret == true)
 	{
+		// Primitives draw from buffers uploaded on first use
+		Primitive::SetMeshCache(&meshes);
+
 		//Use Vsync
 		if (VSYNC && SDL_GL_SetSwapInterval(1) < 0)
 		{
@@ -150,6 +166,9 @@ bool ModuleRenderer3D::Init(JSON_Object* data)
 		{
 			glEnable(GL_TEXTURE_2D);
 		}
+
+		// Spheres draw a shared unit mesh scaled by their radius
+		glEnable(GL_RESCALE_NORMAL);
 	}
 
 	// Projection matrix for
@@ -173,6 +192,10 @@ update_status ModuleRenderer3D::PreUpdate(float dt)
 	
 	// light 0 on cam pos
 	lights[0].SetPos(App->camera->Position.x, App->camera->Position.y, App->camera->Position.z);
+	meshes.SetViewPosition(App->camera->Position);
+	float frustumPlanes[6][4];
+	App->camera->GetFrustumPlanes(frustumPlanes);
+	batcher.SetFrustum(frustumPlanes);
 
 	for(uint i = 0; i < MAX_LIGHTS; ++i)
 		lights[i].Render();
@@ -197,6 +220,10 @@ bool ModuleRenderer3D::CleanUp(JSON_Object* data)
 	LOG("Destroying 3D Renderer");
 	App->imGui->AddLogToWindow("Destroying 3D Renderer");
 
+	batcher.CleanUp();
+	meshes.Clear();
+	Primitive::SetMeshCache(nullptr);
+
 	SDL_GL_DeleteContext(context);
 
 	JSON_Object* rendererData = json_object_dotget_object(data, name.c_str());
@@ -218,8 +245,10 @@ void ModuleRenderer3D::OnResize(int width, int height)
 
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
-	ProjectionMatrix = perspective(60.0f, (float)width / (float)height, 0.125f, 512.0f);
+	ProjectionMatrix = perspective(CAMERA_FOV, (float)width / (float)height, CAMERA_NEAR, CAMERA_FAR);
 	glLoadMatrixf(&ProjectionMatrix);
+	meshes.SetViewport((float)height, CAMERA_FOV);
+	App->camera->SetAspectRatio((float)width / (float)height);
 	
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();
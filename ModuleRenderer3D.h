@@ -5,6 +5,8 @@
 #include "Globals.h"
 #include "glmath.h"
 #include "Light.h"
+#include "MeshCache.h"
+#include "BatchRenderer.h"
 
 #define MAX_LIGHTS 8
 
@@ -14,6 +16,7 @@ public:
 	ModuleRenderer3D(Application* app, bool start_enabled = true);
 	~ModuleRenderer3D();
 
+	void DeclareDependencies();
 	bool Init(JSON_Object* data = nullptr);
 	update_status PreUpdate(float dt);
 	update_status PostUpdate(float dt);
@@ -30,6 +33,8 @@ public:
 public:
 
 	Light lights[MAX_LIGHTS];
+	MeshCache meshes;
+	BatchRenderer batcher;
 	SDL_GLContext context;
 	mat3x3 NormalMatrix;
 	mat4x4 ModelMatrix, ViewMatrix, ProjectionMatrix;
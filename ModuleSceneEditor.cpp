@@ -1,28 +1,23 @@
 #include "Application.h"
 #include "ModuleSceneEditor.h"
+#include "PhysBody3D.h"
+#include "TransformKernels.h"
 
 
 ModuleSceneEditor::ModuleSceneEditor(Application* app, bool startEnabled) : Module(app, startEnabled)
 {
 	name = "Scene editor";
+	memoryTag = Mem_Scene;
 }
 ModuleSceneEditor::~ModuleSceneEditor()
+{}
+
+// Update ordering against other modules
+void ModuleSceneEditor::DeclareDependencies()
 {
-	while (!sceneCubes.empty())
-	{
-		delete sceneCubes.front();
-		sceneCubes.pop_front();
-	}
-	while (!sceneCylinders.empty())
-	{
-		delete sceneCylinders.front();
-		sceneCylinders.pop_front();
-	}
-	while (!sceneSpheres.empty())
-	{
-		delete sceneSpheres.front();
-		sceneSpheres.pop_front();
-	}
+	Writes(App->physics);
+	// Transforms are synced right after the physics step
+	Reads(App->physics);
 }
 
 bool ModuleSceneEditor::Init(JSON_Object* data)
@@ -36,6 +31,8 @@ bool ModuleSceneEditor::CleanUp(JSON_Object* data)
 
 update_status ModuleSceneEditor::PreUpdate(float dt)
 {
+	SyncTransforms();
+
 	return UPDATE_CONTINUE;
 }
 update_status ModuleSceneEditor::Update(float dt)
@@ -47,86 +44,229 @@ update_status ModuleSceneEditor::PostUpdate(float dt)
 	return UPDATE_CONTINUE;
 }
 
+// Mesh and scale the shared cache uses for a shape, the only place that knows every shape type
+static const PrimitiveMesh* GetShapeMesh(MeshCache& meshes, const RenderShape& shape, const mat4x4& transform, float& scale)
+{
+	scale = 1.0f;
+
+	switch (shape.type)
+	{
+	case Primitive_Cube:
+		return meshes.GetCube(shape.size.x, shape.size.y, shape.size.z);
+	case Primitive_Cylinder:
+		return meshes.GetCylinder(shape.size.x, shape.size.y, CYLINDER_SEGMENTS);
+	case Primitive_Sphere:
+		scale = shape.size.x;
+		return meshes.GetSphere(meshes.SelectSphereLod(transform.translation(), shape.size.x));
+	default:
+		return nullptr;
+	}
+}
+
 void ModuleSceneEditor::Draw()
 {
-	for (std::list<Cube*>::iterator it = sceneCubes.begin(); it != sceneCubes.end(); ++it)
+	BatchRenderer& batcher = App->renderer3D->batcher;
+	MeshCache& meshes = App->renderer3D->meshes;
+
+	float frustumPlanes[6][4];
+	App->camera->GetFrustumPlanes(frustumPlanes);
+
+	visibleObjects.clear();
+	spatialIndex.QueryFrustum(frustumPlanes, visibleObjects);
+
+	for (uint i = 0; i < visibleObjects.size(); ++i)
 	{
-		(*it)->Render();
+		int dense = scene.GetDense(scene.GetEntityFromIndex((uint)(size_t)visibleObjects[i]));
+
+		float scale;
+		const PrimitiveMesh* mesh = GetShapeMesh(meshes, scene.shapes[dense], scene.transforms[dense], scale);
+		if (mesh != nullptr)
+		{
+			batcher.Submit(mesh, scene.transforms[dense], scale, scene.colors[dense], scene.shapes[dense].wire, scene.boundsMin[dense], scene.boundsMax[dense]);
+		}
 	}
-	for (std::list<Cylinder*>::iterator it = sceneCylinders.begin(); it != sceneCylinders.end(); ++it)
+	batcher.AddCulled(scene.Size() - visibleObjects.size());
+
+	batcher.Flush(App->renderer3D->lighting);
+}
+
+void ModuleSceneEditor::SetToWireframe(bool wframe)
+{
+	this->wframe = wframe;
+
+	for (uint i = 0; i < scene.Size(); ++i)
 	{
-		(*it)->Render();
+		scene.shapes[i].wire = wframe;
 	}
-	for (std::list<Sphere*>::iterator it = sceneSpheres.begin(); it != sceneSpheres.end(); ++it)
+}
+
+Entity ModuleSceneEditor::AddCube(vec3 size, vec3 pos)
+{
+	Cube cube(size.x, size.y, size.z);
+	cube.SetPos(pos.x, pos.y, pos.z);
+
+	RenderShape shape = { Primitive_Cube, size, false };
+	return AddEntity(cube, shape, App->physics->AddBody(cube));
+}
+
+Entity ModuleSceneEditor::AddCube(vec3 size, const mat4x4& transform)
+{
+	Cube cube(size.x, size.y, size.z);
+	cube.transform = transform;
+	cube.UpdateBounds();
+
+	RenderShape shape = { Primitive_Cube, size, false };
+	return AddEntity(cube, shape, App->physics->AddBody(cube));
+}
+
+Entity ModuleSceneEditor::AddCylinder(float radius, float height, vec3 pos)
+{
+	Cylinder cyl(radius, height);
+	cyl.SetPos(pos.x, pos.y, pos.z);
+
+	RenderShape shape = { Primitive_Cylinder, vec3(radius, height, 0.0f), false };
+	return AddEntity(cyl, shape, App->physics->AddBody(cyl));
+}
+
+Entity ModuleSceneEditor::AddSphere(float radius, vec3 pos)
+{
+	Sphere sph(radius);
+	sph.SetPos(pos.x, pos.y, pos.z);
+
+	RenderShape shape = { Primitive_Sphere, vec3(radius, radius, radius), false };
+	return AddEntity(sph, shape, App->physics->AddBody(sph));
+}
+
+Entity ModuleSceneEditor::AddEntity(const Primitive& primitive, const RenderShape& shape, PhysBody3D* body)
+{
+	Entity entity = scene.Create(shape, primitive.transform, primitive.color);
+	int dense = scene.GetDense(entity);
+
+	scene.bodies[dense] = body;
+	if (body != nullptr)
 	{
-		(*it)->Render();
+		body->render_id = entity.index;
+		body->collision_listeners.PushBack(this);
 	}
+	scene.proxies[dense] = spatialIndex.CreateProxy(scene.boundsMin[dense], scene.boundsMax[dense], (void*)(size_t)entity.index);
+
+	return entity;
 }
 
-void ModuleSceneEditor::SetToWireframe(bool wframe)
+void ModuleSceneEditor::AddBoxStacks(uint boxes)
 {
-	if (wframe == true)
+	uint columns = (boxes + BOX_STACK_HEIGHT - 1) / BOX_STACK_HEIGHT;
+	uint side = (uint)ceilf(sqrtf((float)columns));
+	float spacing = 1.5f;
+	float offset = (side - 1) * spacing * 0.5f;
+
+	// Axis aligned unit boxes, so only positions go into the batch
+	std::vector<float> positions[3];
+	for (uint c = 0; c < 3; ++c)
 	{
-		for (std::list<Cube*>::iterator it = sceneCubes.begin(); it != sceneCubes.end(); ++it)
-		{
-			(*it)->wire = true;
-		}
-		for (std::list<Cylinder*>::iterator it = sceneCylinders.begin(); it != sceneCylinders.end(); ++it)
-		{
-			(*it)->wire = true;
-		}
-		for (std::list<Sphere*>::iterator it = sceneSpheres.begin(); it != sceneSpheres.end(); ++it)
-		{
-			(*it)->wire = true;
-		}
+		positions[c].resize(boxes);
 	}
-	else
+
+	for (uint i = 0; i < boxes; ++i)
 	{
-		for (std::list<Cube*>::iterator it = sceneCubes.begin(); it != sceneCubes.end(); ++it)
-		{
-			(*it)->wire = false;
-		}
-		for (std::list<Cylinder*>::iterator it = sceneCylinders.begin(); it != sceneCylinders.end(); ++it)
-		{
-			(*it)->wire = false;
-		}
-		for (std::list<Sphere*>::iterator it = sceneSpheres.begin(); it != sceneSpheres.end(); ++it)
-		{
-			(*it)->wire = false;
-		}
+		uint column = i / BOX_STACK_HEIGHT;
+		uint level = i % BOX_STACK_HEIGHT;
+
+		positions[0][i] = (column % side) * spacing - offset;
+		positions[1][i] = 0.5f + level;
+		positions[2][i] = (column / side) * spacing - offset;
+	}
+
+	TransformArrays input;
+	for (uint c = 0; c < 3; ++c)
+	{
+		input.position[c] = positions[c].data();
 	}
+
+	std::vector<mat4x4> transforms(boxes);
+	ComposeTransforms(input, boxes, transforms.data(), &App->jobs);
+
+	for (uint i = 0; i < boxes; ++i)
+	{
+		AddCube(vec3(1, 1, 1), transforms[i]);
+	}
+
+	LOG("Added %u boxes in %u stacks", boxes, columns);
 }
 
-void ModuleSceneEditor::AddCube(vec3 size, vec3 pos)
+void ModuleSceneEditor::RemoveEntity(Entity entity)
 {
-	Cube* cube = new Cube;
-	cube->size.Set(size.x, size.y, size.z);
-	cube->SetPos(pos.x, pos.y, pos.z);
+	int dense = scene.GetDense(entity);
+	if (dense < 0)
+	{
+		return;
+	}
+
+	PhysBody3D* body = scene.bodies[dense];
+	if (body != nullptr)
+	{
+		body->render_id = -1;
+		App->physics->RemoveBody(body);
+	}
 
-	sceneCubes.push_back(cube);
+	spatialIndex.DestroyProxy(scene.proxies[dense]);
+	scene.Destroy(entity);
+}
 
-	App->physics->AddBody(*cube);
+// The entity goes with its body when physics recycles it
+void ModuleSceneEditor::OnBodyRemoved(PhysBody3D* body)
+{
+	if (body->render_id >= 0)
+	{
+		Entity entity = scene.GetEntityFromIndex(body->render_id);
+		body->render_id = -1;
+		RemoveEntity(entity);
+	}
 }
 
-void ModuleSceneEditor::AddCylinder(float radius, float height, vec3 pos)
+void ModuleSceneEditor::UpdateEntity(Entity entity)
 {
-	Cylinder* cyl = new Cylinder;
-	cyl->radius = radius;
-	cyl->height = height;
-	cyl->SetPos(pos.x, pos.y, pos.z);
+	int dense = scene.GetDense(entity);
+	if (dense >= 0)
+	{
+		scene.UpdateBounds(dense);
+		spatialIndex.MoveProxy(scene.proxies[dense], scene.boundsMin[dense], scene.boundsMax[dense]);
+	}
+}
 
-	sceneCylinders.push_back(cyl);
+// Copies the transforms of the bodies the last step moved, one pass over a packed list
+void ModuleSceneEditor::SyncTransforms()
+{
+	const std::vector<MovedBody>& moved = App->physics->GetMovedBodies();
 
-	App->physics->AddBody(*cyl);
+	for (uint i = 0; i < moved.size(); ++i)
+	{
+		if (moved[i].body->render_id < 0)
+		{
+			continue;
+		}
+
+		int dense = scene.GetDense(scene.GetEntityFromIndex(moved[i].body->render_id));
+		if (dense >= 0)
+		{
+			memcpy(scene.transforms[dense].M, moved[i].transform, sizeof(moved[i].transform));
+			scene.UpdateBounds(dense);
+			spatialIndex.MoveProxy(scene.proxies[dense], scene.boundsMin[dense], scene.boundsMax[dense]);
+		}
+	}
 }
 
-void ModuleSceneEditor::AddSphere(float radius, vec3 pos)
+SceneStore& ModuleSceneEditor::GetScene()
 {
-	Sphere* sph = new Sphere;
-	sph->radius = radius;
-	sph->SetPos(pos.x, pos.y, pos.z);
+	return scene;
+}
 
-	sceneSpheres.push_back(sph);
+const AABBTree& ModuleSceneEditor::GetSpatialIndex() const
+{
+	return spatialIndex;
+}
 
-	App->physics->AddBody(*sph);
+uint ModuleSceneEditor::GetObjectCount() const
+{
+	return scene.Size();
 }
\ No newline at end of file
@@ -3,7 +3,11 @@
 
 #include "Module.h"
 #include "Primitive.h"
-#include <list>
+#include "AABBTree.h"
+#include "SceneStore.h"
+#include <vector>
+
+#define BOX_STACK_HEIGHT 10
 
 class ModuleSceneEditor : public Module
 {
@@ -11,6 +15,7 @@ public:
 	ModuleSceneEditor(Application* app, bool startEnabled = true);
 	~ModuleSceneEditor();
 
+	void DeclareDependencies();
 	bool Init(JSON_Object* data = nullptr);
 	bool CleanUp(JSON_Object* data = nullptr);
 
@@ -21,18 +26,36 @@ public:
 	void Draw();
 	void SetToWireframe(bool wframe);
 
-	void AddCube(vec3 size, vec3 pos = vec3(0,0,0));
-	void AddCylinder(float radius, float height, vec3 pos = vec3(0, 0, 0));
-	void AddSphere(float radius, vec3 pos = vec3(0, 0, 0));
+	Entity AddCube(vec3 size, vec3 pos = vec3(0,0,0));
+	Entity AddCube(vec3 size, const mat4x4& transform);
+	Entity AddCylinder(float radius, float height, vec3 pos = vec3(0, 0, 0));
+	Entity AddSphere(float radius, vec3 pos = vec3(0, 0, 0));
+
+	// Benchmark scene: columns of BOX_STACK_HEIGHT unit boxes on a grid
+	void AddBoxStacks(uint boxes);
+
+	// Also removes the entity's physics body
+	void RemoveEntity(Entity entity);
+	void OnBodyRemoved(PhysBody3D* body);
+
+	// Call after moving or resizing an entity so bounds and the spatial index follow
+	void UpdateEntity(Entity entity);
+	SceneStore& GetScene();
+	const AABBTree& GetSpatialIndex() const;
+	uint GetObjectCount() const;
 
 private:
-	//For now ----
-	std::list<Cube*> sceneCubes;
-	std::list<Cylinder*> sceneCylinders;
-	std::list<Sphere*> sceneSpheres;
-	//--------
 
-	bool wframe;
+	Entity AddEntity(const Primitive& primitive, const RenderShape& shape, PhysBody3D* body);
+	void SyncTransforms();
+
+private:
+
+	SceneStore scene;
+	AABBTree spatialIndex;
+	std::vector<void*> visibleObjects;
+
+	bool wframe = false;
 };
 
 #endif
\ No newline at end of file
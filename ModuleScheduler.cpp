@@ -0,0 +1,303 @@
+// ----------------------------------------------------
+// ModuleScheduler.cpp
+// Dependency driven, parallel module update stages
+// ----------------------------------------------------
+
+#include "ModuleScheduler.h"
+#include "Application.h"
+#include "parson\parson.h"
+#include <algorithm>
+
+static const char* stageNames[STAGE_COUNT] = { "PreUpdate", "Update", "PostUpdate" };
+
+// ---------------------------------------------
+ModuleScheduler::ModuleScheduler(Application* app) : App(app)
+{}
+
+// ---------------------------------------------
+ModuleScheduler::~ModuleScheduler()
+{}
+
+// ---------------------------------------------
+bool ModuleScheduler::Build(const p2SmallArray<Module*>& modules)
+{
+	nodes.clear();
+	levels.clear();
+
+	// Disabled modules stay in the graph so ordering through them is kept
+	uint benchmarkIndex = 0;
+	for (uint i = 0; i < modules.Count(); ++i)
+	{
+		Node node;
+		node.module = modules[i];
+		node.benchmarkIndex = modules[i]->IsEnabled() ? benchmarkIndex++ : 0;
+		node.level = 0;
+		nodes.push_back(node);
+	}
+
+	for (uint i = 0; i < nodes.size(); ++i)
+	{
+		const Module* module = nodes[i].module;
+
+		for (uint r = 0; r < module->reads.size(); ++r)
+		{
+			int other = FindNode(module->reads[r]);
+			if (other >= 0 && other != (int)i)
+			{
+				AddEdge(other, i);
+			}
+		}
+
+		for (uint w = 0; w < module->writes.size(); ++w)
+		{
+			int other = FindNode(module->writes[w]);
+			if (other >= 0 && other != (int)i)
+			{
+				AddEdge(other < (int)i ? other : i, other < (int)i ? i : other);
+			}
+
+			// Two writers of the same module can't overlap either
+			for (uint k = i + 1; k < nodes.size(); ++k)
+			{
+				const std::vector<Module*>& otherWrites = nodes[k].module->writes;
+				if (std::find(otherWrites.begin(), otherWrites.end(), module->writes[w]) != otherWrites.end())
+				{
+					AddEdge(i, k);
+				}
+			}
+		}
+	}
+
+	// Kahn's algorithm, a node's level is the longest path leading to it
+	std::vector<uint> inDegree(nodes.size());
+	std::vector<std::vector<uint>> successors(nodes.size());
+	std::vector<uint> ready;
+
+	for (uint i = 0; i < nodes.size(); ++i)
+	{
+		inDegree[i] = nodes[i].after.size();
+		for (uint p = 0; p < nodes[i].after.size(); ++p)
+		{
+			successors[nodes[i].after[p]].push_back(i);
+		}
+		if (inDegree[i] == 0)
+		{
+			ready.push_back(i);
+		}
+	}
+
+	uint sorted = 0;
+	uint levelCount = 0;
+	while (sorted < ready.size())
+	{
+		uint current = ready[sorted++];
+		levelCount = nodes[current].level + 1 > levelCount ? nodes[current].level + 1 : levelCount;
+
+		for (uint s = 0; s < successors[current].size(); ++s)
+		{
+			uint next = successors[current][s];
+			if (nodes[next].level < nodes[current].level + 1)
+			{
+				nodes[next].level = nodes[current].level + 1;
+			}
+			if (--inDegree[next] == 0)
+			{
+				ready.push_back(next);
+			}
+		}
+	}
+
+	if (sorted != nodes.size())
+	{
+		LOG("Module dependency cycle detected between:");
+		for (uint i = 0; i < nodes.size(); ++i)
+		{
+			if (inDegree[i] > 0)
+			{
+				LOG("  %s", nodes[i].module->name.c_str());
+			}
+		}
+		return false;
+	}
+
+	levels.resize(levelCount);
+	for (uint i = 0; i < nodes.size(); ++i)
+	{
+		levels[nodes[i].level].push_back(i);
+	}
+
+	tasks.resize(nodes.size());
+	results.resize(nodes.size(), UPDATE_CONTINUE);
+
+	return true;
+}
+
+// ---------------------------------------------
+update_status ModuleScheduler::Run(update_stage stage)
+{
+	update_status ret = UPDATE_CONTINUE;
+
+	for (uint l = 0; l < levels.size() && ret == UPDATE_CONTINUE; ++l)
+	{
+		const std::vector<uint>& level = levels[l];
+
+		uint runnable = 0;
+		for (uint i = 0; i < level.size(); ++i)
+		{
+			if (nodes[level[i]].module->IsEnabled())
+			{
+				++runnable;
+			}
+		}
+
+		// Worker jobs first so they run while the main thread handles its own modules
+		JobCounter counter;
+		for (uint i = 0; i < level.size(); ++i)
+		{
+			const Module* module = nodes[level[i]].module;
+			if (runnable > 1 && module->IsEnabled() && !module->mainThread[stage])
+			{
+				tasks[level[i]].scheduler = this;
+				tasks[level[i]].node = level[i];
+				tasks[level[i]].stage = stage;
+				App->jobs.Run(&RunStageJob, &tasks[level[i]], &counter);
+			}
+		}
+
+		for (uint i = 0; i < level.size(); ++i)
+		{
+			const Module* module = nodes[level[i]].module;
+			if (module->IsEnabled() && (runnable <= 1 || module->mainThread[stage]))
+			{
+				RunNode(level[i], stage);
+			}
+		}
+
+		App->jobs.Wait(counter);
+
+		for (uint i = 0; i < level.size() && ret == UPDATE_CONTINUE; ++i)
+		{
+			if (nodes[level[i]].module->IsEnabled())
+			{
+				ret = results[level[i]];
+			}
+		}
+	}
+
+	return ret;
+}
+
+// ---------------------------------------------
+void ModuleScheduler::LogSchedule() const
+{
+	for (uint l = 0; l < levels.size(); ++l)
+	{
+		std::string names;
+		for (uint i = 0; i < levels[l].size(); ++i)
+		{
+			if (i > 0)
+			{
+				names += ", ";
+			}
+			names += nodes[levels[l][i]].module->name;
+		}
+		LOG("Update level %u: %s", l, names.c_str());
+	}
+}
+
+// ---------------------------------------------
+bool ModuleScheduler::SaveSchedule(const char* path) const
+{
+	JSON_Value* rootValue = json_value_init_object();
+	JSON_Object* root = json_value_get_object(rootValue);
+
+	JSON_Value* levelsValue = json_value_init_array();
+	JSON_Array* levelsArray = json_value_get_array(levelsValue);
+
+	for (uint l = 0; l < levels.size(); ++l)
+	{
+		JSON_Value* levelValue = json_value_init_array();
+		JSON_Array* levelArray = json_value_get_array(levelValue);
+
+		for (uint i = 0; i < levels[l].size(); ++i)
+		{
+			json_array_append_string(levelArray, nodes[levels[l][i]].module->name.c_str());
+		}
+		json_array_append_value(levelsArray, levelValue);
+	}
+	json_object_set_value(root, "levels", levelsValue);
+
+	JSON_Value* modulesValue = json_value_init_object();
+	JSON_Object* modulesObject = json_value_get_object(modulesValue);
+
+	for (uint i = 0; i < nodes.size(); ++i)
+	{
+		JSON_Value* moduleValue = json_value_init_object();
+		JSON_Object* moduleObject = json_value_get_object(moduleValue);
+
+		json_object_set_boolean(moduleObject, "enabled", nodes[i].module->IsEnabled());
+		json_object_set_number(moduleObject, "level", nodes[i].level);
+
+		JSON_Value* afterValue = json_value_init_array();
+		for (uint p = 0; p < nodes[i].after.size(); ++p)
+		{
+			json_array_append_string(json_value_get_array(afterValue), nodes[nodes[i].after[p]].module->name.c_str());
+		}
+		json_object_set_value(moduleObject, "after", afterValue);
+
+		JSON_Value* mainThreadValue = json_value_init_array();
+		for (uint stage = 0; stage < STAGE_COUNT; ++stage)
+		{
+			if (nodes[i].module->mainThread[stage])
+			{
+				json_array_append_string(json_value_get_array(mainThreadValue), stageNames[stage]);
+			}
+		}
+		json_object_set_value(moduleObject, "mainThread", mainThreadValue);
+
+		json_object_set_value(modulesObject, nodes[i].module->name.c_str(), moduleValue);
+	}
+	json_object_set_value(root, "modules", modulesValue);
+
+	bool ret = json_serialize_to_file_pretty(rootValue, path) == JSONSuccess;
+	json_value_free(rootValue);
+
+	return ret;
+}
+
+// ---------------------------------------------
+int ModuleScheduler::FindNode(const Module* module) const
+{
+	for (uint i = 0; i < nodes.size(); ++i)
+	{
+		if (nodes[i].module == module)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+// ---------------------------------------------
+void ModuleScheduler::AddEdge(uint from, uint to)
+{
+	std::vector<uint>& after = nodes[to].after;
+
+	if (std::find(after.begin(), after.end(), from) == after.end())
+	{
+		after.push_back(from);
+	}
+}
+
+// ---------------------------------------------
+void ModuleScheduler::RunNode(uint node, update_stage stage)
+{
+	results[node] = App->UpdateModule(nodes[node].module, nodes[node].benchmarkIndex, stage);
+}
+
+// ---------------------------------------------
+void ModuleScheduler::RunStageJob(void* data, uint begin, uint end)
+{
+	StageTask* task = (StageTask*)data;
+	task->scheduler->RunNode(task->node, task->stage);
+}
@@ -0,0 +1,63 @@
+#ifndef __MODULESCHEDULER_H__
+#define __MODULESCHEDULER_H__
+
+#include "Globals.h"
+#include "p2SmallArray.h"
+#include <vector>
+
+class Application;
+class Module;
+
+// ----------------------------------------------------
+// Builds a DAG from the dependencies modules declare and
+// runs each update stage level by level: modules in the
+// same level are independent and run on the job system,
+// except stages that must stay on the main thread
+// ----------------------------------------------------
+class ModuleScheduler
+{
+public:
+
+	ModuleScheduler(Application* app);
+	~ModuleScheduler();
+
+	bool Build(const p2SmallArray<Module*>& modules);
+	update_status Run(update_stage stage);
+
+	void LogSchedule() const;
+	bool SaveSchedule(const char* path) const;
+
+private:
+
+	struct Node
+	{
+		Module* module;
+		uint benchmarkIndex;
+		uint level;
+		std::vector<uint> after;
+	};
+
+	struct StageTask
+	{
+		ModuleScheduler* scheduler;
+		uint node;
+		update_stage stage;
+	};
+
+	int FindNode(const Module* module) const;
+	void AddEdge(uint from, uint to);
+	void RunNode(uint node, update_stage stage);
+
+	static void RunStageJob(void* data, uint begin, uint end);
+
+private:
+
+	Application* App;
+
+	std::vector<Node> nodes;
+	std::vector<std::vector<uint>> levels;
+	std::vector<StageTask> tasks;
+	std::vector<update_status> results;
+};
+
+#endif // __MODULESCHEDULER_H__
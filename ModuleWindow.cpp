@@ -10,6 +10,7 @@ ModuleWindow::ModuleWindow(Application* app, bool start_enabled) : Module(app, s
 	window = NULL;
 	screen_surface = NULL;
 	name = "window";
+	memoryTag = Mem_Render;
 }
 
 // Destructor
@@ -17,6 +18,12 @@ ModuleWindow::~ModuleWindow()
 {
 }
 
+// Update ordering against other modules
+void ModuleWindow::DeclareDependencies()
+{
+	RequireMainThread();
+}
+
 // Called before render is available
 bool ModuleWindow::Init(JSON_Object* data)
 {
@@ -15,6 +15,7 @@ public:
 	// Destructor
 	virtual ~ModuleWindow();
 
+	void DeclareDependencies();
 	bool Init(JSON_Object* data = nullptr);
 	bool CleanUp(JSON_Object* data = nullptr);
 
@@ -0,0 +1,149 @@
+#ifndef __OBJECTPOOL_H__
+#define __OBJECTPOOL_H__
+
+#include <assert.h>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#define OBJECT_POOL_CHUNK_SIZE 256
+
+// ----------------------------------------------------
+// Fixed-size slots carved from chunks of CHUNK objects.
+// Acquire and Release are O(1) through a free list,
+// memory only grows a chunk at a time and Clear tears
+// everything down at once
+// ----------------------------------------------------
+template<class TYPE, unsigned int CHUNK = OBJECT_POOL_CHUNK_SIZE>
+class ObjectPool
+{
+private:
+
+	struct Slot
+	{
+		typename std::aligned_storage<sizeof(TYPE), alignof(TYPE)>::type storage;
+		Slot* next;
+		bool live;
+	};
+
+	struct Chunk
+	{
+		char* memory;
+		Slot* slots;
+		Chunk* next;
+	};
+
+	Chunk*			chunks;
+	Slot*			free_list;
+	unsigned int	num_live;
+	unsigned int	capacity;
+
+public:
+
+	ObjectPool() : chunks(NULL), free_list(NULL), num_live(0), capacity(0)
+	{}
+
+	~ObjectPool()
+	{
+		Clear();
+	}
+
+	template<class... ARGS>
+	TYPE* Acquire(ARGS&&... args)
+	{
+		if(free_list == NULL)
+			AddChunk();
+
+		Slot* slot = free_list;
+		free_list = slot->next;
+
+		TYPE* object = new (&slot->storage) TYPE(std::forward<ARGS>(args)...);
+		slot->live = true;
+		++num_live;
+
+		return object;
+	}
+
+	void Release(TYPE* object)
+	{
+		if(object == NULL)
+			return;
+
+		// storage is the first member, so the object address is the slot address
+		Slot* slot = reinterpret_cast<Slot*>(object);
+		assert(slot->live);
+
+		object->~TYPE();
+		slot->live = false;
+		slot->next = free_list;
+		free_list = slot;
+		--num_live;
+	}
+
+	// Grows until at least count objects fit without allocating
+	void Reserve(unsigned int count)
+	{
+		while(capacity < count)
+			AddChunk();
+	}
+
+	// Destroys every live object and frees all chunks
+	void Clear()
+	{
+		while(chunks != NULL)
+		{
+			Chunk* chunk = chunks;
+			chunks = chunk->next;
+
+			for(unsigned int i = 0; i < CHUNK; ++i)
+			{
+				if(chunk->slots[i].live)
+					reinterpret_cast<TYPE*>(&chunk->slots[i].storage)->~TYPE();
+			}
+
+			delete[] chunk->memory;
+			delete chunk;
+		}
+
+		free_list = NULL;
+		num_live = 0;
+		capacity = 0;
+	}
+
+	unsigned int Count() const
+	{
+		return num_live;
+	}
+
+	unsigned int Capacity() const
+	{
+		return capacity;
+	}
+
+private:
+
+	void AddChunk()
+	{
+		Chunk* chunk = new Chunk;
+		chunk->memory = new char[CHUNK * sizeof(Slot) + alignof(Slot)];
+
+		// new[] only guarantees fundamental alignment, Bullet types want 16
+		size_t address = (size_t)chunk->memory;
+		size_t aligned = (address + alignof(Slot) - 1) & ~(size_t)(alignof(Slot) - 1);
+		chunk->slots = reinterpret_cast<Slot*>(aligned);
+
+		// Link back to front so slots are handed out in address order
+		for(int i = CHUNK - 1; i >= 0; --i)
+		{
+			chunk->slots[i].live = false;
+			chunk->slots[i].next = free_list;
+			free_list = &chunk->slots[i];
+		}
+
+		chunk->next = chunks;
+		chunks = chunk;
+		capacity += CHUNK;
+	}
+};
+
+#endif // __OBJECTPOOL_H__
@@ -0,0 +1,118 @@
+// ----------------------------------------------------
+// ParallelDispatcher.cpp
+// Narrowphase collision split across the job system
+// ----------------------------------------------------
+
+#include "ParallelDispatcher.h"
+#include "JobSystem.h"
+
+// The pools are sized for the largest algorithm, which is now ours
+static btDefaultCollisionConstructionInfo ConstructionInfo()
+{
+	btDefaultCollisionConstructionInfo info;
+	info.m_customCollisionAlgorithmMaxElementSize = sizeof(LocalSimplexConvexAlgorithm);
+	return info;
+}
+
+// PARALLEL COLLISION CONFIGURATION ======================
+ParallelCollisionConfiguration::ParallelCollisionConfiguration() : btDefaultCollisionConfiguration(ConstructionInfo()), convexConvexCreateFunc(m_pdSolver)
+{}
+
+// ---------------------------------------------
+btCollisionAlgorithmCreateFunc* ParallelCollisionConfiguration::getCollisionAlgorithmCreateFunc(int proxyType0, int proxyType1)
+{
+	btCollisionAlgorithmCreateFunc* createFunc = btDefaultCollisionConfiguration::getCollisionAlgorithmCreateFunc(proxyType0, proxyType1);
+	return createFunc == m_convexConvexCreateFunc ? &convexConvexCreateFunc : createFunc;
+}
+
+// PARALLEL DISPATCHER ===================================
+// ---------------------------------------------
+ParallelDispatcher::ParallelDispatcher(btCollisionConfiguration* collisionConfiguration, JobSystem* jobs) : btCollisionDispatcher(collisionConfiguration), jobs(jobs)
+{}
+
+// ---------------------------------------------
+ParallelDispatcher::~ParallelDispatcher()
+{}
+
+// ---------------------------------------------
+void ParallelDispatcher::SetThreadCount(uint threads)
+{
+	this->threads = threads;
+}
+
+// ---------------------------------------------
+uint ParallelDispatcher::GetThreadCount() const
+{
+	return threads;
+}
+
+// ---------------------------------------------
+void ParallelDispatcher::dispatchAllCollisionPairs(btOverlappingPairCache* pairCache, const btDispatcherInfo& dispatchInfo, btDispatcher* dispatcher)
+{
+	btBroadphasePairArray& pairArray = pairCache->getOverlappingPairArray();
+	uint count = pairArray.size();
+
+	if (threads <= 1 || jobs == nullptr || count < threads * JOB_MIN_BATCH)
+	{
+		btCollisionDispatcher::dispatchAllCollisionPairs(pairCache, dispatchInfo, dispatcher);
+		return;
+	}
+
+	DispatchTask task;
+	task.dispatcher = this;
+	task.pairs = &pairArray[0];
+	task.dispatchInfo = &dispatchInfo;
+
+	// One contiguous range per requested thread, the job system caps the real concurrency
+	JobCounter counter;
+	uint rangeSize = (count + threads - 1) / threads;
+
+	for (uint begin = 0; begin < count; begin += rangeSize)
+	{
+		uint end = begin + rangeSize < count ? begin + rangeSize : count;
+		jobs->Run(&DispatchJob, &task, &counter, nullptr, begin, end);
+	}
+
+	jobs->Wait(counter);
+}
+
+// ---------------------------------------------
+// Same per pair work btCollisionDispatcher does through its overlap callback
+void ParallelDispatcher::DispatchJob(void* data, uint begin, uint end)
+{
+	DispatchTask* task = (DispatchTask*)data;
+	btNearCallback nearCallback = task->dispatcher->getNearCallback();
+
+	for (uint i = begin; i < end; ++i)
+	{
+		nearCallback(task->pairs[i], *task->dispatcher, *task->dispatchInfo);
+	}
+}
+
+// ---------------------------------------------
+btPersistentManifold* ParallelDispatcher::getNewManifold(const btCollisionObject* b0, const btCollisionObject* b1)
+{
+	std::lock_guard<std::recursive_mutex> lock(poolMutex);
+	return btCollisionDispatcher::getNewManifold(b0, b1);
+}
+
+// ---------------------------------------------
+void ParallelDispatcher::releaseManifold(btPersistentManifold* manifold)
+{
+	std::lock_guard<std::recursive_mutex> lock(poolMutex);
+	btCollisionDispatcher::releaseManifold(manifold);
+}
+
+// ---------------------------------------------
+void* ParallelDispatcher::allocateCollisionAlgorithm(int size)
+{
+	std::lock_guard<std::recursive_mutex> lock(poolMutex);
+	return btCollisionDispatcher::allocateCollisionAlgorithm(size);
+}
+
+// ---------------------------------------------
+void ParallelDispatcher::freeCollisionAlgorithm(void* ptr)
+{
+	std::lock_guard<std::recursive_mutex> lock(poolMutex);
+	btCollisionDispatcher::freeCollisionAlgorithm(ptr);
+}
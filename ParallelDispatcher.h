@@ -0,0 +1,102 @@
+#ifndef __PARALLELDISPATCHER_H__
+#define __PARALLELDISPATCHER_H__
+
+#include "Globals.h"
+#include "Bullet/include/btBulletDynamicsCommon.h"
+#include "Bullet/include/BulletCollision/CollisionDispatch/btConvexConvexAlgorithm.h"
+#include <mutex>
+
+class JobSystem;
+
+// btConvexConvexAlgorithm with a simplex solver of its own. The stock create
+// function hands every algorithm the configuration's single solver, which
+// pairs processed at the same time on different threads would share
+class LocalSimplexConvexAlgorithm : public btConvexConvexAlgorithm
+{
+public:
+	// Only the address of simplexSolver goes to the base, it isn't used before the body runs
+	LocalSimplexConvexAlgorithm(const btCollisionAlgorithmConstructionInfo& ci, const btCollisionObjectWrapper* body0Wrap, const btCollisionObjectWrapper* body1Wrap, btConvexPenetrationDepthSolver* pdSolver, int numPerturbationIterations, int minimumPointsPerturbationThreshold)
+		: btConvexConvexAlgorithm(ci.m_manifold, ci, body0Wrap, body1Wrap, &simplexSolver, pdSolver, numPerturbationIterations, minimumPointsPerturbationThreshold)
+	{}
+
+	struct CreateFunc : public btConvexConvexAlgorithm::CreateFunc
+	{
+		CreateFunc(btConvexPenetrationDepthSolver* pdSolver) : btConvexConvexAlgorithm::CreateFunc(nullptr, pdSolver)
+		{}
+
+		btCollisionAlgorithm* CreateCollisionAlgorithm(btCollisionAlgorithmConstructionInfo& ci, const btCollisionObjectWrapper* body0Wrap, const btCollisionObjectWrapper* body1Wrap)
+		{
+			void* mem = ci.m_dispatcher1->allocateCollisionAlgorithm(sizeof(LocalSimplexConvexAlgorithm));
+			return new(mem) LocalSimplexConvexAlgorithm(ci, body0Wrap, body1Wrap, m_pdSolver, m_numPerturbationIterations, m_minimumPointsPerturbationThreshold);
+		}
+	};
+
+private:
+	btVoronoiSimplexSolver simplexSolver;
+};
+
+// ----------------------------------------------------
+// Default collision configuration whose convex-convex
+// pairs (also used per triangle and compound child) get
+// LocalSimplexConvexAlgorithm, so the narrowphase holds
+// no solver state shared between pairs. The penetration
+// depth solver (GJK-EPA) keeps everything on the stack
+// ----------------------------------------------------
+class ParallelCollisionConfiguration : public btDefaultCollisionConfiguration
+{
+public:
+
+	ParallelCollisionConfiguration();
+
+	btCollisionAlgorithmCreateFunc* getCollisionAlgorithmCreateFunc(int proxyType0, int proxyType1);
+
+private:
+
+	LocalSimplexConvexAlgorithm::CreateFunc convexConvexCreateFunc;
+};
+
+// ----------------------------------------------------
+// Collision dispatcher that runs the narrowphase of the
+// overlapping pairs on the engine job system. Everything
+// touching shared dispatcher state (manifold and algorithm
+// pools) is serialized, each pair is processed by one job.
+// Needs a ParallelCollisionConfiguration to run threaded
+// ----------------------------------------------------
+class ParallelDispatcher : public btCollisionDispatcher
+{
+public:
+
+	ParallelDispatcher(btCollisionConfiguration* collisionConfiguration, JobSystem* jobs);
+	~ParallelDispatcher();
+
+	// 0 or 1 keeps Bullet's sequential dispatch
+	void SetThreadCount(uint threads);
+	uint GetThreadCount() const;
+
+	void dispatchAllCollisionPairs(btOverlappingPairCache* pairCache, const btDispatcherInfo& dispatchInfo, btDispatcher* dispatcher);
+
+	btPersistentManifold* getNewManifold(const btCollisionObject* b0, const btCollisionObject* b1);
+	void releaseManifold(btPersistentManifold* manifold);
+	void* allocateCollisionAlgorithm(int size);
+	void freeCollisionAlgorithm(void* ptr);
+
+private:
+
+	struct DispatchTask
+	{
+		ParallelDispatcher* dispatcher;
+		btBroadphasePair* pairs;
+		const btDispatcherInfo* dispatchInfo;
+	};
+
+	static void DispatchJob(void* data, uint begin, uint end);
+
+private:
+
+	JobSystem* jobs;
+	uint threads = 0;
+
+	std::recursive_mutex poolMutex;
+};
+
+#endif // __PARALLELDISPATCHER_H__
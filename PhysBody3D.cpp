@@ -9,10 +9,9 @@ PhysBody3D::PhysBody3D(btRigidBody* body) : body(body)
 }
 
 // ---------------------------------------------------------
+// The rigid body belongs to ModulePhysics3D's pool
 PhysBody3D::~PhysBody3D()
-{
-	delete body;
-}
+{}
 
 // ---------------------------------------------------------
 void PhysBody3D::Push(float x, float y, float z)
@@ -110,6 +109,10 @@ btRigidBody* PhysBody3D::GetRigidBody() {
 	return body;
 }
 
+bool PhysBody3D::IsPendingRemoval() const {
+	return pending_removal;
+}
+
 void PhysBody3D::SetFriction(int friction) {
 	body->setFriction(friction);
 }
\ No newline at end of file
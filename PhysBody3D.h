@@ -1,7 +1,7 @@
 #ifndef __PhysBody3D_H__
 #define __PhysBody3D_H__
 
-#include "p2List.h"
+#include "p2SmallArray.h"
 #include "glmath.h"
 
 class btRigidBody;
@@ -27,6 +27,7 @@ public:
 	vec3 CheckPointPos()const;
 	int CheckPointId() const;
 	btRigidBody* GetRigidBody();
+	bool IsPendingRemoval() const;
 
 private:
 	btRigidBody* body = nullptr;
@@ -34,9 +35,14 @@ private:
 	bool is_checkpoint = false;
 	vec3 checkpoint_pos = { 0,0,0 };
 	int id = 0;
+	bool pending_removal = false;
+	// Simulation time at which the body is recycled, 0 keeps it
+	float expire_time = 0.0f;
 
 public:
-	p2List<Module*> collision_listeners;
+	p2SmallArray<Module*, 2> collision_listeners;
+	// Entity whose render transform follows this body, -1 for none
+	int render_id = -1;
 };
 
 #endif // __PhysBody3D_H__
\ No newline at end of file
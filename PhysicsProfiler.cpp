@@ -0,0 +1,185 @@
+// ----------------------------------------------------
+// PhysicsProfiler.cpp
+// Per phase physics step timings, graphs and traces
+// ----------------------------------------------------
+
+#include "PhysicsProfiler.h"
+#include "parson\parson.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* phaseNames[PHASE_COUNT] = { "broadphase", "narrowphase", "solver", "integration", "listeners" };
+
+// ---------------------------------------------
+PhysicsProfiler::PhysicsProfiler()
+{
+	memset(&current, 0, sizeof(current));
+	memset(&last, 0, sizeof(last));
+	memset(phaseHistory, 0, sizeof(phaseHistory));
+	memset(totalHistory, 0, sizeof(totalHistory));
+}
+
+// ---------------------------------------------
+PhysicsProfiler::~PhysicsProfiler()
+{}
+
+// ---------------------------------------------
+void PhysicsProfiler::BeginFrame()
+{
+	memset(&current, 0, sizeof(current));
+}
+
+// ---------------------------------------------
+void PhysicsProfiler::AddPhase(PhysicsPhase phase, double ms)
+{
+	current.phaseMs[phase] += (float)ms;
+}
+
+// ---------------------------------------------
+void PhysicsProfiler::EndFrame(double totalMs, uint substeps, uint bodies, uint pairs, uint manifolds, uint contacts)
+{
+	current.totalMs = (float)totalMs;
+	current.substeps = substeps;
+	current.bodies = bodies;
+	current.pairs = pairs;
+	current.manifolds = manifolds;
+	current.contacts = contacts;
+
+	last = current;
+
+	for (uint i = 0; i < PHASE_COUNT; ++i)
+	{
+		phaseHistory[i][historyOffset] = last.phaseMs[i];
+	}
+	totalHistory[historyOffset] = last.totalMs;
+	historyOffset = (historyOffset + 1) % PHYSICS_PROFILE_HISTORY;
+
+	if (recording)
+	{
+		trace.push_back(last);
+	}
+}
+
+// ---------------------------------------------
+const PhysicsFrameSample& PhysicsProfiler::GetLastFrame() const
+{
+	return last;
+}
+
+// ---------------------------------------------
+const float* PhysicsProfiler::GetPhaseHistory(PhysicsPhase phase) const
+{
+	return phaseHistory[phase];
+}
+
+// ---------------------------------------------
+const float* PhysicsProfiler::GetTotalHistory() const
+{
+	return totalHistory;
+}
+
+// ---------------------------------------------
+uint PhysicsProfiler::GetHistoryOffset() const
+{
+	return historyOffset;
+}
+
+// ---------------------------------------------
+void PhysicsProfiler::SetRecording(bool recording)
+{
+	this->recording = recording;
+}
+
+// ---------------------------------------------
+bool PhysicsProfiler::IsRecording() const
+{
+	return recording;
+}
+
+// ---------------------------------------------
+uint PhysicsProfiler::GetTraceSize() const
+{
+	return trace.size();
+}
+
+// ---------------------------------------------
+void PhysicsProfiler::ClearTrace()
+{
+	trace.clear();
+}
+
+// ---------------------------------------------
+bool PhysicsProfiler::SaveCSV(const char* path) const
+{
+	FILE* file = fopen(path, "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	fprintf(file, "frame");
+	for (uint i = 0; i < PHASE_COUNT; ++i)
+	{
+		fprintf(file, ",%s_ms", phaseNames[i]);
+	}
+	fprintf(file, ",total_ms,substeps,bodies,pairs,manifolds,contacts\n");
+
+	for (uint f = 0; f < trace.size(); ++f)
+	{
+		const PhysicsFrameSample& sample = trace[f];
+
+		fprintf(file, "%u", f);
+		for (uint i = 0; i < PHASE_COUNT; ++i)
+		{
+			fprintf(file, ",%.4f", sample.phaseMs[i]);
+		}
+		fprintf(file, ",%.4f,%u,%u,%u,%u,%u\n", sample.totalMs, sample.substeps, sample.bodies, sample.pairs, sample.manifolds, sample.contacts);
+	}
+
+	fclose(file);
+	return true;
+}
+
+// ---------------------------------------------
+bool PhysicsProfiler::SaveJSON(const char* path) const
+{
+	JSON_Value* rootValue = json_value_init_object();
+	JSON_Object* root = json_value_get_object(rootValue);
+
+	JSON_Value* framesValue = json_value_init_array();
+	JSON_Array* frames = json_value_get_array(framesValue);
+
+	for (uint f = 0; f < trace.size(); ++f)
+	{
+		const PhysicsFrameSample& sample = trace[f];
+
+		JSON_Value* frameValue = json_value_init_object();
+		JSON_Object* frame = json_value_get_object(frameValue);
+
+		for (uint i = 0; i < PHASE_COUNT; ++i)
+		{
+			json_object_set_number(frame, phaseNames[i], sample.phaseMs[i]);
+		}
+		json_object_set_number(frame, "total", sample.totalMs);
+		json_object_set_number(frame, "substeps", sample.substeps);
+		json_object_set_number(frame, "bodies", sample.bodies);
+		json_object_set_number(frame, "pairs", sample.pairs);
+		json_object_set_number(frame, "manifolds", sample.manifolds);
+		json_object_set_number(frame, "contacts", sample.contacts);
+
+		json_array_append_value(frames, frameValue);
+	}
+
+	json_object_set_value(root, "frames", framesValue);
+
+	bool ret = json_serialize_to_file_pretty(rootValue, path) == JSONSuccess;
+	json_value_free(rootValue);
+
+	return ret;
+}
+
+// ---------------------------------------------
+const char* PhysicsProfiler::GetPhaseName(PhysicsPhase phase)
+{
+	return phaseNames[phase];
+}
@@ -0,0 +1,80 @@
+#ifndef __PHYSICSPROFILER_H__
+#define __PHYSICSPROFILER_H__
+
+#include "Globals.h"
+#include <vector>
+
+// Frames kept for the rolling graphs
+#define PHYSICS_PROFILE_HISTORY 120
+
+#define PHYSICS_TRACE_CSV "physics_trace.csv"
+#define PHYSICS_TRACE_JSON "physics_trace.json"
+
+enum PhysicsPhase
+{
+	Phase_Broadphase,
+	Phase_Narrowphase,
+	Phase_Solver,
+	Phase_Integration,
+	Phase_Listeners,
+	PHASE_COUNT
+};
+
+// One frame of physics: phase times summed over its substeps
+struct PhysicsFrameSample
+{
+	float phaseMs[PHASE_COUNT];
+	float totalMs;
+	uint substeps;
+	uint bodies;
+	uint pairs;
+	uint manifolds;
+	uint contacts;
+};
+
+// ----------------------------------------------------
+// Accumulates per phase physics timings for each frame,
+// keeps a rolling history for graphs and, while
+// recording, a full trace that can be saved to disk
+// ----------------------------------------------------
+class PhysicsProfiler
+{
+public:
+
+	PhysicsProfiler();
+	~PhysicsProfiler();
+
+	void BeginFrame();
+	void AddPhase(PhysicsPhase phase, double ms);
+	void EndFrame(double totalMs, uint substeps, uint bodies, uint pairs, uint manifolds, uint contacts);
+
+	const PhysicsFrameSample& GetLastFrame() const;
+	// Ring buffer of PHYSICS_PROFILE_HISTORY values, oldest at GetHistoryOffset()
+	const float* GetPhaseHistory(PhysicsPhase phase) const;
+	const float* GetTotalHistory() const;
+	uint GetHistoryOffset() const;
+
+	void SetRecording(bool recording);
+	bool IsRecording() const;
+	uint GetTraceSize() const;
+	void ClearTrace();
+
+	bool SaveCSV(const char* path) const;
+	bool SaveJSON(const char* path) const;
+
+	static const char* GetPhaseName(PhysicsPhase phase);
+
+private:
+
+	PhysicsFrameSample current;
+	PhysicsFrameSample last;
+
+	float phaseHistory[PHASE_COUNT][PHYSICS_PROFILE_HISTORY];
+	float totalHistory[PHYSICS_PROFILE_HISTORY];
+	uint historyOffset = 0;
+
+	bool recording = false;
+	std::vector<PhysicsFrameSample> trace;
+};
+
+#endif // __PHYSICSPROFILER_H__
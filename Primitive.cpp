@@ -3,9 +3,35 @@
 #include <gl/GL.h>
 #include <gl/GLU.h>
 #include "Primitive.h"
-#include "glut/glut.h"
+#include "MeshCache.h"
+#include <math.h>
 
-#pragma comment (lib, "glut/glut32.lib")
+MeshCache* Primitive::meshCache = nullptr;
+
+// ------------------------------------------------------------
+// Projects the local box on every axis of the transform (Arvo's method)
+void TransformBounds(const mat4x4& transform, const vec3& localMin, const vec3& localMax, vec3& min, vec3& max)
+{
+	const float* m = transform.M;
+	float localLow[3] = { localMin.x, localMin.y, localMin.z };
+	float localHigh[3] = { localMax.x, localMax.y, localMax.z };
+	float low[3] = { m[12], m[13], m[14] };
+	float high[3] = { m[12], m[13], m[14] };
+
+	for (int row = 0; row < 3; ++row)
+	{
+		for (int column = 0; column < 3; ++column)
+		{
+			float a = m[column * 4 + row] * localLow[column];
+			float b = m[column * 4 + row] * localHigh[column];
+			low[row] += a < b ? a : b;
+			high[row] += a < b ? b : a;
+		}
+	}
+
+	min.Set(low[0], low[1], low[2]);
+	max.Set(high[0], high[1], high[2]);
+}
 
 // ------------------------------------------------------------
 Primitive::Primitive() : transform(IdentityMatrix), color(White), wire(false), axis(false), type(PrimitiveTypes::Primitive_Point)
@@ -17,6 +43,12 @@ PrimitiveTypes Primitive::GetType() const
 	return type;
 }
 
+// ------------------------------------------------------------
+void Primitive::SetMeshCache(MeshCache* cache)
+{
+	meshCache = cache;
+}
+
 // ------------------------------------------------------------
 void Primitive::Render() const
 {
@@ -81,96 +113,146 @@ void Primitive::InnerRender() const
 	glPointSize(1.0f);
 }
 
+// ------------------------------------------------------------
+// Primitives without cached geometry draw themselves in InnerRender
+const PrimitiveMesh* Primitive::GetMesh() const
+{
+	return nullptr;
+}
+
+// ------------------------------------------------------------
+// Uniform scale applied to the cached mesh on top of the transform
+float Primitive::GetMeshScale() const
+{
+	return 1.0f;
+}
+
 // ------------------------------------------------------------
 void Primitive::SetPos(float x, float y, float z)
 {
 	transform.translate(x, y, z);
+	UpdateBounds();
 }
 
 // ------------------------------------------------------------
 void Primitive::SetRotation(float angle, const vec3 &u)
 {
 	transform.rotate(angle, u);
+	UpdateBounds();
 }
 
 // ------------------------------------------------------------
 void Primitive::Scale(float x, float y, float z)
 {
 	transform.scale(x, y, z);
+	UpdateBounds();
+}
+
+// ------------------------------------------------------------
+void Primitive::GetLocalBounds(vec3& min, vec3& max) const
+{
+	min.Set(0.0f, 0.0f, 0.0f);
+	max.Set(0.0f, 0.0f, 0.0f);
+}
+
+// ------------------------------------------------------------
+// Call after writing transform or the shape directly
+void Primitive::UpdateBounds()
+{
+	vec3 localMin, localMax;
+	GetLocalBounds(localMin, localMax);
+	TransformBounds(transform, localMin, localMax, boundsMin, boundsMax);
+}
+
+// ------------------------------------------------------------
+const vec3& Primitive::GetBoundsMin() const
+{
+	return boundsMin;
+}
+
+// ------------------------------------------------------------
+const vec3& Primitive::GetBoundsMax() const
+{
+	return boundsMax;
 }
 
 // CUBE ============================================
 Cube::Cube() : Primitive(), size(1.0f, 1.0f, 1.0f)
 {
 	type = PrimitiveTypes::Primitive_Cube;
+	UpdateBounds();
 }
 
 Cube::Cube(float sizeX, float sizeY, float sizeZ) : Primitive(), size(sizeX, sizeY, sizeZ)
 {
 	type = PrimitiveTypes::Primitive_Cube;
+	UpdateBounds();
 }
 
 void Cube::InnerRender() const
-{	
-	float sx = size.x * 0.5f;
-	float sy = size.y * 0.5f;
-	float sz = size.z * 0.5f;
-
-	glBegin(GL_QUADS);
-
-	glNormal3f(0.0f, 0.0f, 1.0f);
-	glVertex3f(-sx, -sy, sz);
-	glVertex3f( sx, -sy, sz);
-	glVertex3f( sx,  sy, sz);
-	glVertex3f(-sx,  sy, sz);
-
-	glNormal3f(0.0f, 0.0f, -1.0f);
-	glVertex3f( sx, -sy, -sz);
-	glVertex3f(-sx, -sy, -sz);
-	glVertex3f(-sx,  sy, -sz);
-	glVertex3f( sx,  sy, -sz);
-
-	glNormal3f(1.0f, 0.0f, 0.0f);
-	glVertex3f(sx, -sy,  sz);
-	glVertex3f(sx, -sy, -sz);
-	glVertex3f(sx,  sy, -sz);
-	glVertex3f(sx,  sy,  sz);
-
-	glNormal3f(-1.0f, 0.0f, 0.0f);
-	glVertex3f(-sx, -sy, -sz);
-	glVertex3f(-sx, -sy,  sz);
-	glVertex3f(-sx,  sy,  sz);
-	glVertex3f(-sx,  sy, -sz);
-
-	glNormal3f(0.0f, 1.0f, 0.0f);
-	glVertex3f(-sx, sy,  sz);
-	glVertex3f( sx, sy,  sz);
-	glVertex3f( sx, sy, -sz);
-	glVertex3f(-sx, sy, -sz);
-
-	glNormal3f(0.0f, -1.0f, 0.0f);
-	glVertex3f(-sx, -sy, -sz);
-	glVertex3f( sx, -sy, -sz);
-	glVertex3f( sx, -sy,  sz);
-	glVertex3f(-sx, -sy,  sz);
+{
+	const PrimitiveMesh* mesh = GetMesh();
+	if (mesh != nullptr)
+	{
+		mesh->Draw();
+	}
+}
 
-	glEnd();
+void Cube::GetLocalBounds(vec3& min, vec3& max) const
+{
+	min.Set(-size.x * 0.5f, -size.y * 0.5f, -size.z * 0.5f);
+	max.Set(size.x * 0.5f, size.y * 0.5f, size.z * 0.5f);
+}
+
+const PrimitiveMesh* Cube::GetMesh() const
+{
+	return meshCache != nullptr ? meshCache->GetCube(size.x, size.y, size.z) : nullptr;
 }
 
 // SPHERE ============================================
 Sphere::Sphere() : Primitive(), radius(1.0f)
 {
 	type = PrimitiveTypes::Primitive_Sphere;
+	UpdateBounds();
 }
 
 Sphere::Sphere(float radius) : Primitive(), radius(radius)
 {
 	type = PrimitiveTypes::Primitive_Sphere;
+	UpdateBounds();
 }
 
 void Sphere::InnerRender() const
 {
-	glutSolidSphere(radius, 25, 25);
+	const PrimitiveMesh* mesh = GetMesh();
+	if (mesh != nullptr)
+	{
+		glPushMatrix();
+		glScalef(radius, radius, radius);
+		mesh->Draw();
+		glPopMatrix();
+	}
+}
+
+void Sphere::GetLocalBounds(vec3& min, vec3& max) const
+{
+	min.Set(-radius, -radius, -radius);
+	max.Set(radius, radius, radius);
+}
+
+// One set of unit spheres shared by every radius, detail picked by screen size
+const PrimitiveMesh* Sphere::GetMesh() const
+{
+	if (meshCache == nullptr)
+	{
+		return nullptr;
+	}
+	return meshCache->GetSphere(meshCache->SelectSphereLod(transform.translation(), radius));
+}
+
+float Sphere::GetMeshScale() const
+{
+	return radius;
 }
 
 
@@ -178,58 +260,46 @@ void Sphere::InnerRender() const
 Cylinder::Cylinder() : Primitive(), radius(1.0f), height(1.0f)
 {
 	type = PrimitiveTypes::Primitive_Cylinder;
+	UpdateBounds();
 }
 
 Cylinder::Cylinder(float radius, float height) : Primitive(), radius(radius), height(height)
 {
 	type = PrimitiveTypes::Primitive_Cylinder;
+	UpdateBounds();
 }
 
 void Cylinder::InnerRender() const
 {
-	int n = 30;
-
-	// Cylinder Bottom
-	glBegin(GL_POLYGON);
-	
-	for(int i = 360; i >= 0; i -= (360 / n))
-	{
-		float a = i * M_PI / 180; // degrees to radians
-		glVertex3f(-height*0.5f, radius * cos(a), radius * sin(a));
-	}
-	glEnd();
-
-	// Cylinder Top
-	glBegin(GL_POLYGON);
-	glNormal3f(0.0f, 0.0f, 1.0f);
-	for(int i = 0; i <= 360; i += (360 / n))
+	const PrimitiveMesh* mesh = GetMesh();
+	if (mesh != nullptr)
 	{
-		float a = i * M_PI / 180; // degrees to radians
-		glVertex3f(height * 0.5f, radius * cos(a), radius * sin(a));
+		mesh->Draw();
 	}
-	glEnd();
+}
 
-	// Cylinder "Cover"
-	glBegin(GL_QUAD_STRIP);
-	for(int i = 0; i < 480; i += (360 / n))
-	{
-		float a = i * M_PI / 180; // degrees to radians
+void Cylinder::GetLocalBounds(vec3& min, vec3& max) const
+{
+	min.Set(-height * 0.5f, -radius, -radius);
+	max.Set(height * 0.5f, radius, radius);
+}
 
-		glVertex3f(height*0.5f,  radius * cos(a), radius * sin(a) );
-		glVertex3f(-height*0.5f, radius * cos(a), radius * sin(a) );
-	}
-	glEnd();
+const PrimitiveMesh* Cylinder::GetMesh() const
+{
+	return meshCache != nullptr ? meshCache->GetCylinder(radius, height, CYLINDER_SEGMENTS) : nullptr;
 }
 
 // LINE ==================================================
 Line::Line() : Primitive(), origin(0, 0, 0), destination(1, 1, 1)
 {
 	type = PrimitiveTypes::Primitive_Line;
+	UpdateBounds();
 }
 
 Line::Line(float x, float y, float z) : Primitive(), origin(0, 0, 0), destination(x, y, z)
 {
 	type = PrimitiveTypes::Primitive_Line;
+	UpdateBounds();
 }
 
 void Line::InnerRender() const
@@ -246,32 +316,41 @@ void Line::InnerRender() const
 	glLineWidth(1.0f);
 }
 
+void Line::GetLocalBounds(vec3& min, vec3& max) const
+{
+	min.Set(fminf(origin.x, destination.x), fminf(origin.y, destination.y), fminf(origin.z, destination.z));
+	max.Set(fmaxf(origin.x, destination.x), fmaxf(origin.y, destination.y), fmaxf(origin.z, destination.z));
+}
+
 // PLANE ==================================================
 Plane::Plane() : Primitive(), normal(0, 1, 0), constant(1)
 {
 	type = PrimitiveTypes::Primitive_Plane;
+	UpdateBounds();
 }
 
 Plane::Plane(float x, float y, float z, float d) : Primitive(), normal(x, y, z), constant(d)
 {
 	type = PrimitiveTypes::Primitive_Plane;
+	UpdateBounds();
 }
 
 void Plane::InnerRender() const
 {
-	glLineWidth(1.0f);
-
-	glBegin(GL_QUADS);
-
-	float d = 200.0f;
-
-	for(float i = -d; i <= d; i += 1.0f)
+	const PrimitiveMesh* mesh = GetMesh();
+	if (mesh != nullptr)
 	{
-		glVertex3f(i, 0.0f, -d);
-		glVertex3f(i, 0.0f, d);
-		glVertex3f(-d, 0.0f, i);
-		glVertex3f(d, 0.0f, i);
+		mesh->Draw();
 	}
+}
 
-	glEnd();
+void Plane::GetLocalBounds(vec3& min, vec3& max) const
+{
+	min.Set(-PLANE_EXTENT, 0.0f, -PLANE_EXTENT);
+	max.Set(PLANE_EXTENT, 0.0f, PLANE_EXTENT);
+}
+
+const PrimitiveMesh* Plane::GetMesh() const
+{
+	return meshCache != nullptr ? meshCache->GetPlane(PLANE_EXTENT) : nullptr;
 }
\ No newline at end of file
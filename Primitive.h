@@ -3,6 +3,15 @@
 #include "glmath.h"
 #include "Color.h"
 
+#define CYLINDER_SEGMENTS 30
+#define PLANE_EXTENT 200.0f
+
+class MeshCache;
+struct PrimitiveMesh;
+
+// World AABB of a local box under an affine transform
+void TransformBounds(const mat4x4& transform, const vec3& localMin, const vec3& localMax, vec3& min, vec3& max);
+
 enum PrimitiveTypes
 {
 	Primitive_Point,
@@ -21,11 +30,22 @@ public:
 
 	virtual void	Render() const;
 	virtual void	InnerRender() const;
+	virtual const PrimitiveMesh* GetMesh() const;
+	virtual float	GetMeshScale() const;
 	void			SetPos(float x, float y, float z);
 	void			SetRotation(float angle, const vec3 &u);
 	void			Scale(float x, float y, float z);
 	PrimitiveTypes	GetType() const;
 
+	// World space AABB, cached until the transform or shape changes
+	virtual void	GetLocalBounds(vec3& min, vec3& max) const;
+	void			UpdateBounds();
+	const vec3&		GetBoundsMin() const;
+	const vec3&		GetBoundsMax() const;
+
+	// Shared GPU geometry, owned by the renderer
+	static void		SetMeshCache(MeshCache* cache);
+
 public:
 	
 	Color color;
@@ -34,6 +54,9 @@ public:
 
 protected:
 	PrimitiveTypes type;
+	vec3 boundsMin, boundsMax;
+
+	static MeshCache* meshCache;
 };
 
 // ============================================
@@ -43,6 +66,8 @@ public :
 	Cube();
 	Cube(float sizeX, float sizeY, float sizeZ);
 	void InnerRender() const;
+	void GetLocalBounds(vec3& min, vec3& max) const;
+	const PrimitiveMesh* GetMesh() const;
 public:
 	vec3 size;
 };
@@ -54,6 +79,9 @@ public:
 	Sphere();
 	Sphere(float radius);
 	void InnerRender() const;
+	void GetLocalBounds(vec3& min, vec3& max) const;
+	const PrimitiveMesh* GetMesh() const;
+	float GetMeshScale() const;
 public:
 	float radius;
 };
@@ -65,6 +93,8 @@ public:
 	Cylinder();
 	Cylinder(float radius, float height);
 	void InnerRender() const;
+	void GetLocalBounds(vec3& min, vec3& max) const;
+	const PrimitiveMesh* GetMesh() const;
 public:
 	float radius;
 	float height;
@@ -77,6 +107,7 @@ public:
 	Line();
 	Line(float x, float y, float z);
 	void InnerRender() const;
+	void GetLocalBounds(vec3& min, vec3& max) const;
 public:
 	vec3 origin;
 	vec3 destination;
@@ -89,6 +120,8 @@ public:
 	Plane();
 	Plane(float x, float y, float z, float d);
 	void InnerRender() const;
+	void GetLocalBounds(vec3& min, vec3& max) const;
+	const PrimitiveMesh* GetMesh() const;
 public:
 	vec3 normal;
 	float constant;
@@ -0,0 +1,176 @@
+// ----------------------------------------------------
+// SceneStore.cpp
+// Dense component arrays with generational handles
+// ----------------------------------------------------
+
+#include "SceneStore.h"
+
+// ---------------------------------------------
+void GetShapeLocalBounds(const RenderShape& shape, vec3& min, vec3& max)
+{
+	switch (shape.type)
+	{
+	case Primitive_Cube:
+		min.Set(-shape.size.x * 0.5f, -shape.size.y * 0.5f, -shape.size.z * 0.5f);
+		max.Set(shape.size.x * 0.5f, shape.size.y * 0.5f, shape.size.z * 0.5f);
+		break;
+	case Primitive_Sphere:
+		min.Set(-shape.size.x, -shape.size.x, -shape.size.x);
+		max.Set(shape.size.x, shape.size.x, shape.size.x);
+		break;
+	case Primitive_Cylinder:
+		min.Set(-shape.size.y * 0.5f, -shape.size.x, -shape.size.x);
+		max.Set(shape.size.y * 0.5f, shape.size.x, shape.size.x);
+		break;
+	default:
+		min.Set(0.0f, 0.0f, 0.0f);
+		max.Set(0.0f, 0.0f, 0.0f);
+		break;
+	}
+}
+
+// ---------------------------------------------
+SceneStore::SceneStore()
+{}
+
+// ---------------------------------------------
+SceneStore::~SceneStore()
+{}
+
+// ---------------------------------------------
+Entity SceneStore::Create(const RenderShape& shape, const mat4x4& transform, const Color& color)
+{
+	Entity entity;
+
+	if (!freeIndices.empty())
+	{
+		entity.index = freeIndices.back();
+		freeIndices.pop_back();
+	}
+	else
+	{
+		entity.index = generations.size();
+		generations.push_back(0);
+		indexToDense.push_back(ENTITY_INVALID);
+	}
+	entity.generation = generations[entity.index];
+
+	uint dense = denseToIndex.size();
+	indexToDense[entity.index] = dense;
+	denseToIndex.push_back(entity.index);
+
+	transforms.push_back(transform);
+	shapes.push_back(shape);
+	colors.push_back(color);
+	boundsMin.push_back(vec3());
+	boundsMax.push_back(vec3());
+	bodies.push_back(nullptr);
+	proxies.push_back(-1);
+
+	UpdateBounds(dense);
+
+	return entity;
+}
+
+// ---------------------------------------------
+void SceneStore::Destroy(Entity entity)
+{
+	int dense = GetDense(entity);
+	if (dense < 0)
+	{
+		return;
+	}
+
+	// Move the last entity into the hole to keep the arrays packed
+	uint last = denseToIndex.size() - 1;
+	if ((uint)dense != last)
+	{
+		transforms[dense] = transforms[last];
+		shapes[dense] = shapes[last];
+		colors[dense] = colors[last];
+		boundsMin[dense] = boundsMin[last];
+		boundsMax[dense] = boundsMax[last];
+		bodies[dense] = bodies[last];
+		proxies[dense] = proxies[last];
+
+		denseToIndex[dense] = denseToIndex[last];
+		indexToDense[denseToIndex[dense]] = dense;
+	}
+
+	transforms.pop_back();
+	shapes.pop_back();
+	colors.pop_back();
+	boundsMin.pop_back();
+	boundsMax.pop_back();
+	bodies.pop_back();
+	proxies.pop_back();
+	denseToIndex.pop_back();
+
+	indexToDense[entity.index] = ENTITY_INVALID;
+	generations[entity.index]++;
+	freeIndices.push_back(entity.index);
+}
+
+// ---------------------------------------------
+bool SceneStore::IsAlive(Entity entity) const
+{
+	return entity.index < generations.size() && generations[entity.index] == entity.generation && indexToDense[entity.index] != ENTITY_INVALID;
+}
+
+// ---------------------------------------------
+void SceneStore::Clear()
+{
+	transforms.clear();
+	shapes.clear();
+	colors.clear();
+	boundsMin.clear();
+	boundsMax.clear();
+	bodies.clear();
+	proxies.clear();
+
+	denseToIndex.clear();
+	indexToDense.clear();
+	generations.clear();
+	freeIndices.clear();
+}
+
+// ---------------------------------------------
+uint SceneStore::Size() const
+{
+	return denseToIndex.size();
+}
+
+// ---------------------------------------------
+int SceneStore::GetDense(Entity entity) const
+{
+	return IsAlive(entity) ? (int)indexToDense[entity.index] : -1;
+}
+
+// ---------------------------------------------
+Entity SceneStore::GetEntity(uint dense) const
+{
+	Entity entity;
+	entity.index = denseToIndex[dense];
+	entity.generation = generations[entity.index];
+	return entity;
+}
+
+// ---------------------------------------------
+Entity SceneStore::GetEntityFromIndex(uint index) const
+{
+	Entity entity;
+	if (index < generations.size() && indexToDense[index] != ENTITY_INVALID)
+	{
+		entity.index = index;
+		entity.generation = generations[index];
+	}
+	return entity;
+}
+
+// ---------------------------------------------
+void SceneStore::UpdateBounds(uint dense)
+{
+	vec3 localMin, localMax;
+	GetShapeLocalBounds(shapes[dense], localMin, localMax);
+	TransformBounds(transforms[dense], localMin, localMax, boundsMin[dense], boundsMax[dense]);
+}
@@ -0,0 +1,83 @@
+#ifndef __SCENESTORE_H__
+#define __SCENESTORE_H__
+
+#include "Globals.h"
+#include "glmath.h"
+#include "Color.h"
+#include "Primitive.h"
+#include <vector>
+
+#define ENTITY_INVALID 0xFFFFFFFF
+
+struct PhysBody3D;
+
+// Index into the sparse table plus the generation it was handed out with,
+// so a handle to a destroyed entity never resolves to whoever reuses the slot
+struct Entity
+{
+	uint index = ENTITY_INVALID;
+	uint generation = 0;
+
+	bool operator==(const Entity& other) const
+	{
+		return index == other.index && generation == other.generation;
+	}
+};
+
+// What to draw: cube uses size, sphere size.x as radius,
+// cylinder size.x as radius and size.y as height
+struct RenderShape
+{
+	PrimitiveTypes type;
+	vec3 size;
+	bool wire;
+};
+
+// ----------------------------------------------------
+// Entity-component store for the scene. Components live
+// in dense parallel arrays (one per component) so systems
+// walk them linearly; removal swaps the last entity in
+// ----------------------------------------------------
+class SceneStore
+{
+public:
+
+	SceneStore();
+	~SceneStore();
+
+	Entity Create(const RenderShape& shape, const mat4x4& transform, const Color& color);
+	void Destroy(Entity entity);
+	bool IsAlive(Entity entity) const;
+	void Clear();
+
+	uint Size() const;
+	// Position in the component arrays, -1 for dead handles
+	int GetDense(Entity entity) const;
+	Entity GetEntity(uint dense) const;
+	Entity GetEntityFromIndex(uint index) const;
+
+	// Recomputes the world AABB of one entity from its shape and transform
+	void UpdateBounds(uint dense);
+
+public:
+
+	// Component arrays, all Size() long. Index them, never resize them
+	std::vector<mat4x4> transforms;
+	std::vector<RenderShape> shapes;
+	std::vector<Color> colors;
+	std::vector<vec3> boundsMin;
+	std::vector<vec3> boundsMax;
+	std::vector<PhysBody3D*> bodies;
+	std::vector<int> proxies;
+
+private:
+
+	std::vector<uint> denseToIndex;
+	std::vector<uint> indexToDense;
+	std::vector<uint> generations;
+	std::vector<uint> freeIndices;
+};
+
+void GetShapeLocalBounds(const RenderShape& shape, vec3& min, vec3& max);
+
+#endif // __SCENESTORE_H__
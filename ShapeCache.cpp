@@ -0,0 +1,155 @@
+// ----------------------------------------------------
+// ShapeCache.cpp
+// Shared, refcounted Bullet collision shapes
+// ----------------------------------------------------
+
+#include "ShapeCache.h"
+#include "Bullet/include/btBulletDynamicsCommon.h"
+
+// ---------------------------------------------
+bool ShapeCache::ShapeKey::operator<(const ShapeKey& other) const
+{
+	if (type != other.type) return type < other.type;
+	if (a != other.a) return a < other.a;
+	if (b != other.b) return b < other.b;
+	return c < other.c;
+}
+
+// ---------------------------------------------
+ShapeCache::ShapeCache()
+{}
+
+// ---------------------------------------------
+ShapeCache::~ShapeCache()
+{
+	Clear();
+}
+
+// ---------------------------------------------
+btCollisionShape* ShapeCache::AcquireBox(const vec3& halfExtents)
+{
+	ShapeKey key = { Shape_Box, halfExtents.x, halfExtents.y, halfExtents.z };
+	return Acquire(key);
+}
+
+// ---------------------------------------------
+btCollisionShape* ShapeCache::AcquireSphere(float radius)
+{
+	ShapeKey key = { Shape_Sphere, radius, 0.0f, 0.0f };
+	return Acquire(key);
+}
+
+// ---------------------------------------------
+btCollisionShape* ShapeCache::AcquireCylinderX(float halfHeight, float radius)
+{
+	ShapeKey key = { Shape_CylinderX, halfHeight, radius, 0.0f };
+	return Acquire(key);
+}
+
+// ---------------------------------------------
+btCollisionShape* ShapeCache::Acquire(const ShapeKey& key)
+{
+	std::map<ShapeKey, btCollisionShape*>::iterator found = lookup.find(key);
+	if (found != lookup.end())
+	{
+		shapes[found->second].references++;
+		referenceCount++;
+		return found->second;
+	}
+
+	btCollisionShape* shape = nullptr;
+	switch (key.type)
+	{
+	case Shape_Box:
+		shape = new btBoxShape(btVector3(key.a, key.b, key.c));
+		break;
+	case Shape_Sphere:
+		shape = new btSphereShape(key.a);
+		break;
+	case Shape_CylinderX:
+		shape = new btCylinderShapeX(btVector3(key.a, key.b, 0.0f));
+		break;
+	}
+
+	SharedShape& shared = shapes[shape];
+	shared.key = key;
+	shared.references = 1;
+	referenceCount++;
+
+	lookup[key] = shape;
+
+	return shape;
+}
+
+// ---------------------------------------------
+void ShapeCache::Release(btCollisionShape* shape)
+{
+	std::map<btCollisionShape*, SharedShape>::iterator found = shapes.find(shape);
+	if (found == shapes.end())
+	{
+		return;
+	}
+
+	referenceCount--;
+	if (--found->second.references == 0)
+	{
+		lookup.erase(found->second.key);
+		shapes.erase(found);
+		delete shape;
+	}
+}
+
+// ---------------------------------------------
+vec3 ShapeCache::GetLocalInertia(btCollisionShape* shape, float mass)
+{
+	if (mass == 0.0f)
+	{
+		return vec3(0.0f, 0.0f, 0.0f);
+	}
+
+	std::map<btCollisionShape*, SharedShape>::iterator found = shapes.find(shape);
+	if (found != shapes.end())
+	{
+		std::map<float, vec3>::iterator cached = found->second.inertia.find(mass);
+		if (cached != found->second.inertia.end())
+		{
+			return cached->second;
+		}
+	}
+
+	btVector3 localInertia(0, 0, 0);
+	shape->calculateLocalInertia(mass, localInertia);
+
+	vec3 inertia(localInertia.getX(), localInertia.getY(), localInertia.getZ());
+	if (found != shapes.end())
+	{
+		found->second.inertia[mass] = inertia;
+	}
+
+	return inertia;
+}
+
+// ---------------------------------------------
+void ShapeCache::Clear()
+{
+	for (std::map<btCollisionShape*, SharedShape>::iterator it = shapes.begin(); it != shapes.end(); ++it)
+	{
+		delete it->first;
+	}
+
+	shapes.clear();
+	lookup.clear();
+	referenceCount = 0;
+}
+
+// ---------------------------------------------
+uint ShapeCache::GetShapeCount() const
+{
+	return shapes.size();
+}
+
+// ---------------------------------------------
+uint ShapeCache::GetReferenceCount() const
+{
+	return referenceCount;
+}
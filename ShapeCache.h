@@ -0,0 +1,69 @@
+#ifndef __SHAPECACHE_H__
+#define __SHAPECACHE_H__
+
+#include "Globals.h"
+#include "glmath.h"
+#include <map>
+
+class btCollisionShape;
+
+enum CollisionShapeType
+{
+	Shape_Box,
+	Shape_Sphere,
+	Shape_CylinderX
+};
+
+// ----------------------------------------------------
+// Interns collision shapes by type and dimensions so
+// bodies of the same size share one btCollisionShape,
+// refcounted, with local inertia cached per mass
+// ----------------------------------------------------
+class ShapeCache
+{
+public:
+
+	ShapeCache();
+	~ShapeCache();
+
+	// Each Acquire adds a reference that a Release must drop
+	btCollisionShape* AcquireBox(const vec3& halfExtents);
+	btCollisionShape* AcquireSphere(float radius);
+	btCollisionShape* AcquireCylinderX(float halfHeight, float radius);
+	void Release(btCollisionShape* shape);
+
+	vec3 GetLocalInertia(btCollisionShape* shape, float mass);
+
+	// Deletes every shape regardless of references
+	void Clear();
+
+	uint GetShapeCount() const;
+	uint GetReferenceCount() const;
+
+private:
+
+	struct ShapeKey
+	{
+		CollisionShapeType type;
+		float a, b, c;
+
+		bool operator<(const ShapeKey& other) const;
+	};
+
+	struct SharedShape
+	{
+		ShapeKey key;
+		uint references;
+		std::map<float, vec3> inertia;
+	};
+
+	btCollisionShape* Acquire(const ShapeKey& key);
+
+private:
+
+	std::map<ShapeKey, btCollisionShape*> lookup;
+	std::map<btCollisionShape*, SharedShape> shapes;
+	uint referenceCount = 0;
+};
+
+#endif // __SHAPECACHE_H__
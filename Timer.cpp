@@ -15,27 +15,53 @@ Timer::Timer()
 void Timer::Start()
 {
 	running = true;
-	started_at = SDL_GetTicks();
+	started_at = math::Clock::Tick();
 }
 
 // ---------------------------------------------
 void Timer::Stop()
 {
 	running = false;
-	stopped_at = SDL_GetTicks();
+	stopped_at = math::Clock::Tick();
 }
 
 // ---------------------------------------------
 Uint32 Timer::Read()
+{
+	return (Uint32)(ReadNs() / 1000000);
+}
+
+// ---------------------------------------------
+uint64 Timer::ReadTicks()
 {
 	if(running == true)
 	{
-		return SDL_GetTicks() - started_at;
+		return math::Clock::TicksInBetween(math::Clock::Tick(), started_at);
 	}
 	else
 	{
-		return stopped_at - started_at;
+		return math::Clock::TicksInBetween(stopped_at, started_at);
 	}
 }
 
+// ---------------------------------------------
+uint64 Timer::ReadNs()
+{
+	// Split in whole seconds and remainder so the multiply can't overflow
+	uint64 ticks = ReadTicks();
+	uint64 frequency = math::Clock::TicksPerSec();
+
+	return (ticks / frequency) * 1000000000ULL + (ticks % frequency) * 1000000000ULL / frequency;
+}
 
+// ---------------------------------------------
+double Timer::ReadMs()
+{
+	return math::Clock::TicksToMillisecondsD(ReadTicks());
+}
+
+// ---------------------------------------------
+float Timer::ReadSec()
+{
+	return (float)math::Clock::TicksToSecondsD(ReadTicks());
+}
@@ -3,7 +3,9 @@
 
 #include "Globals.h"
 #include "SDL\include\SDL.h"
+#include "MathGeo\Time\Clock.h"
 
+// High resolution monotonic timer built on MathGeo's Clock ticks
 class Timer
 {
 public:
@@ -15,12 +17,16 @@ public:
 	void Stop();
 
 	Uint32 Read();
+	uint64 ReadTicks();
+	uint64 ReadNs();
+	double ReadMs();
+	float ReadSec();
 
 private:
 
-	bool	running;
-	Uint32	started_at;
-	Uint32	stopped_at;
+	bool			running;
+	math::tick_t	started_at;
+	math::tick_t	stopped_at;
 };
 
-#endif //__TIMER_H__
\ No newline at end of file
+#endif //__TIMER_H__
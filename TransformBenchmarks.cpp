@@ -0,0 +1,159 @@
+// ----------------------------------------------------
+// TransformBenchmarks.cpp
+// Batched transform kernels against composing one
+// matrix per object with glmath
+// ----------------------------------------------------
+
+#include "MicroBenchmark.h"
+#include "TransformKernels.h"
+#include "JobSystem.h"
+#include <vector>
+#include <string.h>
+
+#define TRANSFORM_BENCH_OBJECTS 50000
+#define TRANSFORM_BENCH_REPEATS 20
+// glmath builds the rotation from angle-axis with sin/cos, relative to the largest element
+#define TRANSFORM_BENCH_TOLERANCE 1e-5
+
+static double MaxRelativeDifference(const mat4x4& a, const mat4x4& b)
+{
+	double largest = 1.0, error = 0.0;
+	for (uint i = 0; i < 16; ++i)
+	{
+		largest = fabs(b.M[i]) > largest ? fabs(b.M[i]) : largest;
+	}
+	for (uint i = 0; i < 16; ++i)
+	{
+		double difference = fabs((double)a.M[i] - b.M[i]) / largest;
+		error = difference > error ? difference : error;
+	}
+	return error;
+}
+
+// ---------------------------------------------
+void RunTransformBenchmarks(MicroBenchmark& bench, JobSystem& jobs)
+{
+	const uint count = TRANSFORM_BENCH_OBJECTS;
+
+	// Scene data as angle-axis for glmath and as SoA quaternions for the kernels
+	std::vector<float> positions[3], rotations[4], scales[3];
+	std::vector<float> angles(count);
+	std::vector<vec3> axes(count);
+	std::vector<int> parents(count);
+
+	for (uint c = 0; c < 3; ++c)
+	{
+		positions[c].resize(count);
+		scales[c].resize(count);
+	}
+	for (uint c = 0; c < 4; ++c)
+	{
+		rotations[c].resize(count);
+	}
+
+	uint seed = 54321u;
+	for (uint i = 0; i < count; ++i)
+	{
+		for (uint c = 0; c < 3; ++c)
+		{
+			positions[c][i] = RandomRange(seed, -100.0f, 100.0f);
+			scales[c][i] = RandomRange(seed, 0.5f, 2.0f);
+		}
+
+		vec3 axis = RandomVec3(seed, -1.0f, 1.0f);
+		axes[i] = length2(axis) < 0.01f ? vec3(0.0f, 1.0f, 0.0f) : normalize(axis);
+		angles[i] = RandomRange(seed, -180.0f, 180.0f);
+
+		float half = angles[i] * DEGTORAD * 0.5f;
+		rotations[0][i] = axes[i].x * sinf(half);
+		rotations[1][i] = axes[i].y * sinf(half);
+		rotations[2][i] = axes[i].z * sinf(half);
+		rotations[3][i] = cosf(half);
+
+		// Small trees: every object but the first of each group of 8 hangs from the one before
+		parents[i] = (i % 8 == 0) ? -1 : (int)i - 1;
+	}
+
+	TransformArrays input;
+	for (uint c = 0; c < 3; ++c)
+	{
+		input.position[c] = positions[c].data();
+		input.scale[c] = scales[c].data();
+	}
+	for (uint c = 0; c < 4; ++c)
+	{
+		input.rotation[c] = rotations[c].data();
+	}
+
+	std::vector<mat4x4> world(count), parallelWorld(count), results(count);
+
+	// Checks
+	ComposeTransforms(input, count, world.data());
+	ComposeTransforms(input, count, parallelWorld.data(), &jobs);
+
+	bool exact = true;
+	double error = 0.0;
+	for (uint i = 0; i < count; ++i)
+	{
+		mat4x4 single = ComposeTransform(positions[0][i], positions[1][i], positions[2][i], rotations[0][i], rotations[1][i], rotations[2][i], rotations[3][i], scales[0][i], scales[1][i], scales[2][i]);
+		exact = exact && memcmp(single.M, world[i].M, sizeof(single.M)) == 0;
+
+		mat4x4 reference = translate(positions[0][i], positions[1][i], positions[2][i]) * rotate(angles[i], axes[i]) * scale(scales[0][i], scales[1][i], scales[2][i]);
+		double difference = MaxRelativeDifference(world[i], reference);
+		error = difference > error ? difference : error;
+	}
+	bench.Check("transforms", "batched matches single", exact, 0.0);
+	bench.Check("transforms", "batched matches glmath", error <= TRANSFORM_BENCH_TOLERANCE, error);
+	bench.Check("transforms", "parallel matches batched", memcmp(world.data(), parallelWorld.data(), count * sizeof(mat4x4)) == 0, 0.0);
+
+	// Timings
+	bench.Run("transforms", "glmath translate * rotate * scale", TRANSFORM_BENCH_REPEATS, [&]()
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			results[i] = translate(positions[0][i], positions[1][i], positions[2][i]) * rotate(angles[i], axes[i]) * scale(scales[0][i], scales[1][i], scales[2][i]);
+		}
+		return results.size();
+	});
+
+	bench.Run("transforms", "ComposeTransform per object", TRANSFORM_BENCH_REPEATS, [&]()
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			results[i] = ComposeTransform(positions[0][i], positions[1][i], positions[2][i], rotations[0][i], rotations[1][i], rotations[2][i], rotations[3][i], scales[0][i], scales[1][i], scales[2][i]);
+		}
+		return results.size();
+	});
+
+	bench.Run("transforms", "ComposeTransforms", TRANSFORM_BENCH_REPEATS, [&]()
+	{
+		ComposeTransforms(input, count, results.data());
+		return results.size();
+	});
+
+	bench.Run("transforms", "ComposeTransforms parallel", TRANSFORM_BENCH_REPEATS, [&]()
+	{
+		ComposeTransforms(input, count, results.data(), &jobs);
+		return results.size();
+	});
+
+	mat4x4 view = look(vec3(10.0f, 20.0f, 30.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+
+	bench.Run("transforms", "MultiplyTransforms", TRANSFORM_BENCH_REPEATS, [&]()
+	{
+		MultiplyTransforms(view, world.data(), count, results.data());
+		return results.size();
+	});
+
+	bench.Run("transforms", "MultiplyTransforms parallel", TRANSFORM_BENCH_REPEATS, [&]()
+	{
+		MultiplyTransforms(view, world.data(), count, results.data(), &jobs);
+		return results.size();
+	});
+
+	bench.Run("transforms", "ResolveHierarchy", TRANSFORM_BENCH_REPEATS, [&]()
+	{
+		ResolveHierarchy(world.data(), parents.data(), count, results.data());
+		return results.size();
+	});
+}
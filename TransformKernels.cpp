@@ -0,0 +1,188 @@
+// ----------------------------------------------------
+// TransformKernels.cpp
+// World and model-view matrices for many objects at once
+// ----------------------------------------------------
+
+#include "TransformKernels.h"
+#include "JobSystem.h"
+
+#if GLMATH_SIMD
+#include <emmintrin.h>
+#endif
+
+// ---------------------------------------------
+mat4x4 ComposeTransform(float px, float py, float pz, float qx, float qy, float qz, float qw, float sx, float sy, float sz)
+{
+	float xx = qx * qx, yy = qy * qy, zz = qz * qz;
+	float xy = qx * qy, xz = qx * qz, yz = qy * qz;
+	float wx = qw * qx, wy = qw * qy, wz = qw * qz;
+
+	mat4x4 world;
+
+	world.M[0] = (1.0f - 2.0f * (yy + zz)) * sx;
+	world.M[1] = 2.0f * (xy + wz) * sx;
+	world.M[2] = 2.0f * (xz - wy) * sx;
+	world.M[3] = 0.0f;
+	world.M[4] = 2.0f * (xy - wz) * sy;
+	world.M[5] = (1.0f - 2.0f * (xx + zz)) * sy;
+	world.M[6] = 2.0f * (yz + wx) * sy;
+	world.M[7] = 0.0f;
+	world.M[8] = 2.0f * (xz + wy) * sz;
+	world.M[9] = 2.0f * (yz - wx) * sz;
+	world.M[10] = (1.0f - 2.0f * (xx + yy)) * sz;
+	world.M[11] = 0.0f;
+	world.M[12] = px;
+	world.M[13] = py;
+	world.M[14] = pz;
+	world.M[15] = 1.0f;
+
+	return world;
+}
+
+// ---------------------------------------------
+static float Read(const float* array, uint i, float identity)
+{
+	return array != nullptr ? array[i] : identity;
+}
+
+#if GLMATH_SIMD
+
+// ---------------------------------------------
+static __m128 Load(const float* array, uint i, float identity)
+{
+	return array != nullptr ? _mm_loadu_ps(array + i) : _mm_set1_ps(identity);
+}
+
+// ---------------------------------------------
+// Rows of one column for four objects, transposed into that column of each
+static void StoreColumn(mat4x4* world, uint column, __m128 r0, __m128 r1, __m128 r2, __m128 r3)
+{
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+	_mm_storeu_ps(&world[0].M[column * 4], r0);
+	_mm_storeu_ps(&world[1].M[column * 4], r1);
+	_mm_storeu_ps(&world[2].M[column * 4], r2);
+	_mm_storeu_ps(&world[3].M[column * 4], r3);
+}
+
+#endif // GLMATH_SIMD
+
+// ---------------------------------------------
+// Same arithmetic as ComposeTransform, one object per lane
+static void ComposeRange(const TransformArrays& input, uint begin, uint end, mat4x4* world)
+{
+	uint i = begin;
+
+#if GLMATH_SIMD
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 qx = Load(input.rotation[0], i, 0.0f);
+		__m128 qy = Load(input.rotation[1], i, 0.0f);
+		__m128 qz = Load(input.rotation[2], i, 0.0f);
+		__m128 qw = Load(input.rotation[3], i, 1.0f);
+		__m128 sx = Load(input.scale[0], i, 1.0f);
+		__m128 sy = Load(input.scale[1], i, 1.0f);
+		__m128 sz = Load(input.scale[2], i, 1.0f);
+
+		__m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+		__m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+		__m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+		StoreColumn(world + i, 0,
+			_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+			_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx),
+			_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx),
+			zero);
+
+		StoreColumn(world + i, 1,
+			_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy),
+			_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+			_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy),
+			zero);
+
+		StoreColumn(world + i, 2,
+			_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz),
+			_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz),
+			_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz),
+			zero);
+
+		StoreColumn(world + i, 3, _mm_loadu_ps(input.position[0] + i), _mm_loadu_ps(input.position[1] + i), _mm_loadu_ps(input.position[2] + i), one);
+	}
+#endif
+
+	for (; i < end; ++i)
+	{
+		world[i] = ComposeTransform(input.position[0][i], input.position[1][i], input.position[2][i],
+			Read(input.rotation[0], i, 0.0f), Read(input.rotation[1], i, 0.0f), Read(input.rotation[2], i, 0.0f), Read(input.rotation[3], i, 1.0f),
+			Read(input.scale[0], i, 1.0f), Read(input.scale[1], i, 1.0f), Read(input.scale[2], i, 1.0f));
+	}
+}
+
+// ---------------------------------------------
+// ParallelFor's own split rounded up to whole SIMD groups
+static uint BatchSize(const JobSystem* jobs, uint count)
+{
+	uint batches = jobs->GetThreadCount() * 4;
+	uint batchSize = (count + batches - 1) / batches;
+	batchSize = (batchSize + TRANSFORM_SIMD_WIDTH - 1) & ~(TRANSFORM_SIMD_WIDTH - 1);
+
+	return batchSize > TRANSFORM_JOB_BATCH ? batchSize : TRANSFORM_JOB_BATCH;
+}
+
+// ---------------------------------------------
+void ComposeTransforms(const TransformArrays& input, uint count, mat4x4* world, JobSystem* jobs)
+{
+	if (jobs != nullptr && count >= TRANSFORM_PARALLEL_MIN)
+	{
+		jobs->ParallelFor(count, [&input, world](uint begin, uint end)
+		{
+			ComposeRange(input, begin, end, world);
+		}, BatchSize(jobs, count));
+	}
+	else
+	{
+		ComposeRange(input, 0, count, world);
+	}
+}
+
+// ---------------------------------------------
+void MultiplyTransforms(const mat4x4& left, const mat4x4* right, uint count, mat4x4* out, JobSystem* jobs)
+{
+	if (jobs != nullptr && count >= TRANSFORM_PARALLEL_MIN)
+	{
+		jobs->ParallelFor(count, [&left, right, out](uint begin, uint end)
+		{
+			for (uint i = begin; i < end; ++i)
+			{
+				out[i] = left * right[i];
+			}
+		}, BatchSize(jobs, count));
+	}
+	else
+	{
+		for (uint i = 0; i < count; ++i)
+		{
+			out[i] = left * right[i];
+		}
+	}
+}
+
+// ---------------------------------------------
+void ResolveHierarchy(const mat4x4* local, const int* parents, uint count, mat4x4* world)
+{
+	for (uint i = 0; i < count; ++i)
+	{
+		if (parents[i] < 0)
+		{
+			world[i] = local[i];
+		}
+		else
+		{
+			world[i] = world[parents[i]] * local[i];
+		}
+	}
+}
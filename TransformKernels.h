@@ -0,0 +1,46 @@
+#ifndef __TRANSFORMKERNELS_H__
+#define __TRANSFORMKERNELS_H__
+
+#include "Globals.h"
+#include "glmath.h"
+
+class JobSystem;
+
+// Below this many objects the job system costs more than it saves
+#define TRANSFORM_PARALLEL_MIN 4096
+// Fewest objects per job. Batches are rounded up to a multiple of
+// TRANSFORM_SIMD_WIDTH so only the last one has scalar leftovers
+#define TRANSFORM_JOB_BATCH 1024
+#define TRANSFORM_SIMD_WIDTH 4
+
+// Structure of arrays input for ComposeTransforms, one float per object
+// in each array. rotation is a unit quaternion (x, y, z, w), nullptr
+// rotation or scale arrays stand for identity and unit scale
+struct TransformArrays
+{
+	const float* position[3] = { nullptr, nullptr, nullptr };
+	const float* rotation[4] = { nullptr, nullptr, nullptr, nullptr };
+	const float* scale[3] = { nullptr, nullptr, nullptr };
+};
+
+// ----------------------------------------------------
+// Bulk transform math. ComposeTransforms builds world
+// matrices four objects at a time (one per SSE lane),
+// the others run glmath's SIMD matrix product per object.
+// Passing a job system splits large counts across it
+// ----------------------------------------------------
+
+// world[i] = translate(position) * rotation * scale(scale)
+void ComposeTransforms(const TransformArrays& input, uint count, mat4x4* world, JobSystem* jobs = nullptr);
+
+// Same as ComposeTransforms for a single object, also used for the leftovers of a batch
+mat4x4 ComposeTransform(float px, float py, float pz, float qx, float qy, float qz, float qw, float sx, float sy, float sz);
+
+// out[i] = left * right[i], i.e. model-view matrices from a view and world matrices
+void MultiplyTransforms(const mat4x4& left, const mat4x4* right, uint count, mat4x4* out, JobSystem* jobs = nullptr);
+
+// world[i] = world[parents[i]] * local[i], roots have parent -1. Parents must come
+// before their children, each object then only needs its parent already resolved
+void ResolveHierarchy(const mat4x4* local, const int* parents, uint count, mat4x4* world);
+
+#endif // __TRANSFORMKERNELS_H__
@@ -82,7 +82,7 @@ vec3 mix(const vec3 &u, const vec3 &v, float a)
 	return u * (1.0f - a) + v * a;
 }
 
-vec3 normalize(const vec3 &u)
+vec3 scalar_normalize(const vec3 &u)
 {
 	return u / sqrt(u.x * u.x + u.y * u.y + u.z * u.z);
 }
@@ -460,7 +460,7 @@ const float* mat4x4::operator & () const
 	return (float*)this;
 }
 
-mat4x4 operator * (const mat4x4 &Matrix1, const mat4x4 &Matrix2)
+mat4x4 scalar_multiply(const mat4x4 &Matrix1, const mat4x4 &Matrix2)
 {
 	mat4x4 Matrix3;
 
@@ -484,7 +484,7 @@ mat4x4 operator * (const mat4x4 &Matrix1, const mat4x4 &Matrix2)
 	return Matrix3;
 }
 
-vec4 operator * (const mat4x4 &Matrix, const vec4 &u)
+vec4 scalar_multiply(const mat4x4 &Matrix, const vec4 &u)
 {
 	vec4 v;
 
@@ -528,35 +528,7 @@ float det3x3sub(const float *m, int i0, int i1, int i2, int i3, int i4, int i5,
 
 mat4x4& mat4x4::inverse()
 {
-	const float *m = M;
-
-	float det = 0.0f;
-
-	det += m[0] * det3x3sub(m, 5, 6, 7, 9, 10, 11, 13, 14, 15);
-	det -= m[4] * det3x3sub(m, 1, 2, 3, 9, 10, 11, 13, 14, 15);
-	det += m[8] * det3x3sub(m, 1, 2, 3, 5, 6, 7, 13, 14, 15);
-	det -= m[12] * det3x3sub(m, 1, 2, 3, 5, 6, 7, 9, 10, 11);
-
-	mat4x4 Inverse;
-
-	Inverse.M[0] = det3x3sub(m, 5, 6, 7, 9, 10, 11, 13, 14, 15) / det;
-	Inverse.M[1] = -det3x3sub(m, 1, 2, 3, 9, 10, 11, 13, 14, 15) / det;
-	Inverse.M[2] = det3x3sub(m, 1, 2, 3, 5, 6, 7, 13, 14, 15) / det;
-	Inverse.M[3] = -det3x3sub(m, 1, 2, 3, 5, 6, 7, 9, 10, 11) / det;
-	Inverse.M[4] = -det3x3sub(m, 4, 6, 7, 8, 10, 11, 12, 14, 15) / det;
-	Inverse.M[5] = det3x3sub(m, 0, 2, 3, 8, 10, 11, 12, 14, 15) / det;
-	Inverse.M[6] = -det3x3sub(m, 0, 2, 3, 4, 6, 7, 12, 14, 15) / det;
-	Inverse.M[7] = det3x3sub(m, 0, 2, 3, 4, 6, 7, 8, 10, 11) / det;
-	Inverse.M[8] = det3x3sub(m, 4, 5, 7, 8, 9, 11, 12, 13, 15) / det;
-	Inverse.M[9] = -det3x3sub(m, 0, 1, 3, 8, 9, 11, 12, 13, 15) / det;
-	Inverse.M[10] = det3x3sub(m, 0, 1, 3, 4, 5, 7, 12, 13, 15) / det;
-	Inverse.M[11] = -det3x3sub(m, 0, 1, 3, 4, 5, 7, 8, 9, 11) / det;
-	Inverse.M[12] = -det3x3sub(m, 4, 5, 6, 8, 9, 10, 12, 13, 14) / det;
-	Inverse.M[13] = det3x3sub(m, 0, 1, 2, 8, 9, 10, 12, 13, 14) / det;
-	Inverse.M[14] = -det3x3sub(m, 0, 1, 2, 4, 5, 6, 12, 13, 14) / det;
-	Inverse.M[15] = det3x3sub(m, 0, 1, 2, 4, 5, 6, 8, 9, 10) / det;
-
-	operator=(Inverse);
+	operator=(::inverse(*this));
 
 	return *this;
 }
@@ -650,26 +622,7 @@ mat4x4& mat4x4::translate(float x, float y, float z)
 
 mat4x4& mat4x4::transpose()
 {
-	mat4x4 Transpose;
-
-	Transpose.M[0] = M[0];
-	Transpose.M[1] = M[4];
-	Transpose.M[2] = M[8];
-	Transpose.M[3] = M[12];
-	Transpose.M[4] = M[1];
-	Transpose.M[5] = M[5];
-	Transpose.M[6] = M[9];
-	Transpose.M[7] = M[13];
-	Transpose.M[8] = M[2];
-	Transpose.M[9] = M[6];
-	Transpose.M[10] = M[10];
-	Transpose.M[11] = M[14];
-	Transpose.M[12] = M[3];
-	Transpose.M[13] = M[7];
-	Transpose.M[14] = M[11];
-	Transpose.M[15] = M[15];
-
-	operator=(Transpose);
+	operator=(::transpose(*this));
 
 	return *this;
 }
@@ -680,7 +633,7 @@ vec3 mat4x4::translation() const
 }
 
 
-mat4x4 inverse(const mat4x4 &Matrix)
+mat4x4 scalar_inverse(const mat4x4 &Matrix)
 {
 	const float *m = Matrix.M;
 
@@ -812,7 +765,7 @@ mat4x4 translate(float x, float y, float z)
 	return Translate;
 }
 
-mat4x4 transpose(const mat4x4 &Matrix)
+mat4x4 scalar_transpose(const mat4x4 &Matrix)
 {
 	mat4x4 Transpose;
 
@@ -834,4 +787,191 @@ mat4x4 transpose(const mat4x4 &Matrix)
 	Transpose.M[15] = Matrix.M[15];
 
 	return Transpose;
-}
\ No newline at end of file
+}
+
+// ----------------------------------------------------------------------------------------------------------------------------
+//
+// SIMD dispatch, see GLMATH_SIMD in glmath.h. Matrices are column major and not necessarily aligned, so columns go
+// through unaligned loads. Operations are issued in the same order as the scalar code so results match bit for bit (no
+// FMA contraction happens on intrinsics)
+//
+// ----------------------------------------------------------------------------------------------------------------------------
+
+#if GLMATH_SIMD
+
+#include <emmintrin.h>
+
+#define GLMATH_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define GLMATH_SWIZZLE(a, x, y, z, w) GLMATH_SHUFFLE(a, a, x, y, z, w)
+
+static inline __m128 load3(const vec3 &u)
+{
+	return _mm_setr_ps(u.x, u.y, u.z, 0.0f);
+}
+
+static inline vec3 store3(__m128 v)
+{
+	float r[4];
+	_mm_storeu_ps(r, v);
+	return vec3(r[0], r[1], r[2]);
+}
+
+// Columns of Matrix1 weighted by one column of Matrix2
+static inline __m128 combine(const __m128 *Columns, const float *u)
+{
+	__m128 r = _mm_mul_ps(Columns[0], _mm_set1_ps(u[0]));
+	r = _mm_add_ps(r, _mm_mul_ps(Columns[1], _mm_set1_ps(u[1])));
+	r = _mm_add_ps(r, _mm_mul_ps(Columns[2], _mm_set1_ps(u[2])));
+	r = _mm_add_ps(r, _mm_mul_ps(Columns[3], _mm_set1_ps(u[3])));
+	return r;
+}
+
+// 2x2 blocks stored as (m00, m01, m10, m11): A * B, adj(A) * B and A * adj(B)
+static inline __m128 mat2mul(__m128 a, __m128 b)
+{
+	return _mm_add_ps(_mm_mul_ps(a, GLMATH_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(GLMATH_SWIZZLE(a, 1, 0, 3, 2), GLMATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+static inline __m128 mat2adjmul(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(GLMATH_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(GLMATH_SWIZZLE(a, 1, 1, 2, 2), GLMATH_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+static inline __m128 mat2muladj(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(a, GLMATH_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(GLMATH_SWIZZLE(a, 1, 0, 3, 2), GLMATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+#endif // GLMATH_SIMD
+
+bool simd_enabled()
+{
+	return GLMATH_SIMD != 0;
+}
+
+vec3 normalize(const vec3 &u)
+{
+#if GLMATH_SIMD
+	__m128 a = load3(u);
+	__m128 squared = _mm_mul_ps(a, a);
+	// (x * x + y * y) + z * z, as the scalar version adds them
+	__m128 sum = _mm_add_ss(_mm_add_ss(squared, GLMATH_SWIZZLE(squared, 1, 1, 1, 1)), GLMATH_SWIZZLE(squared, 2, 2, 2, 2));
+	__m128 norm = _mm_sqrt_ss(sum);
+	return store3(_mm_div_ps(a, GLMATH_SWIZZLE(norm, 0, 0, 0, 0)));
+#else
+	return scalar_normalize(u);
+#endif
+}
+
+mat4x4 operator * (const mat4x4 &Matrix1, const mat4x4 &Matrix2)
+{
+#if GLMATH_SIMD
+	__m128 Columns[4];
+	for(int i = 0; i < 4; i++)
+	{
+		Columns[i] = _mm_loadu_ps(&Matrix1.M[i * 4]);
+	}
+
+	mat4x4 Matrix3;
+	for(int i = 0; i < 4; i++)
+	{
+		_mm_storeu_ps(&Matrix3.M[i * 4], combine(Columns, &Matrix2.M[i * 4]));
+	}
+
+	return Matrix3;
+#else
+	return scalar_multiply(Matrix1, Matrix2);
+#endif
+}
+
+vec4 operator * (const mat4x4 &Matrix, const vec4 &u)
+{
+#if GLMATH_SIMD
+	__m128 Columns[4];
+	for(int i = 0; i < 4; i++)
+	{
+		Columns[i] = _mm_loadu_ps(&Matrix.M[i * 4]);
+	}
+
+	float r[4];
+	_mm_storeu_ps(r, combine(Columns, &u.x));
+	return vec4(r[0], r[1], r[2], r[3]);
+#else
+	return scalar_multiply(Matrix, u);
+#endif
+}
+
+// Block inverse on 2x2 sub-matrices. Working on columns computes the inverse of the transpose, which stored back as
+// columns is the inverse itself
+mat4x4 inverse(const mat4x4 &Matrix)
+{
+#if GLMATH_SIMD
+	__m128 c0 = _mm_loadu_ps(&Matrix.M[0]);
+	__m128 c1 = _mm_loadu_ps(&Matrix.M[4]);
+	__m128 c2 = _mm_loadu_ps(&Matrix.M[8]);
+	__m128 c3 = _mm_loadu_ps(&Matrix.M[12]);
+
+	__m128 A = _mm_movelh_ps(c0, c1);
+	__m128 B = _mm_movehl_ps(c1, c0);
+	__m128 C = _mm_movelh_ps(c2, c3);
+	__m128 D = _mm_movehl_ps(c3, c2);
+
+	// (|A|, |B|, |C|, |D|)
+	__m128 detSub = _mm_sub_ps(_mm_mul_ps(GLMATH_SHUFFLE(c0, c2, 0, 2, 0, 2), GLMATH_SHUFFLE(c1, c3, 1, 3, 1, 3)), _mm_mul_ps(GLMATH_SHUFFLE(c0, c2, 1, 3, 1, 3), GLMATH_SHUFFLE(c1, c3, 0, 2, 0, 2)));
+	__m128 detA = GLMATH_SWIZZLE(detSub, 0, 0, 0, 0);
+	__m128 detB = GLMATH_SWIZZLE(detSub, 1, 1, 1, 1);
+	__m128 detC = GLMATH_SWIZZLE(detSub, 2, 2, 2, 2);
+	__m128 detD = GLMATH_SWIZZLE(detSub, 3, 3, 3, 3);
+
+	__m128 D_C = mat2adjmul(D, C);
+	__m128 A_B = mat2adjmul(A, B);
+	__m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), mat2mul(B, D_C));
+	__m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), mat2mul(C, A_B));
+	__m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), mat2muladj(D, A_B));
+	__m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), mat2muladj(A, D_C));
+
+	// |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+	__m128 trace = _mm_mul_ps(A_B, GLMATH_SWIZZLE(D_C, 0, 2, 1, 3));
+	trace = _mm_add_ps(trace, GLMATH_SWIZZLE(trace, 2, 3, 0, 1));
+	trace = _mm_add_ps(trace, GLMATH_SWIZZLE(trace, 1, 0, 3, 2));
+	__m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+	__m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+	X = _mm_mul_ps(X, invDet);
+	Y = _mm_mul_ps(Y, invDet);
+	Z = _mm_mul_ps(Z, invDet);
+	W = _mm_mul_ps(W, invDet);
+
+	mat4x4 Inverse;
+	_mm_storeu_ps(&Inverse.M[0], GLMATH_SHUFFLE(X, Y, 3, 1, 3, 1));
+	_mm_storeu_ps(&Inverse.M[4], GLMATH_SHUFFLE(X, Y, 2, 0, 2, 0));
+	_mm_storeu_ps(&Inverse.M[8], GLMATH_SHUFFLE(Z, W, 3, 1, 3, 1));
+	_mm_storeu_ps(&Inverse.M[12], GLMATH_SHUFFLE(Z, W, 2, 0, 2, 0));
+
+	return Inverse;
+#else
+	return scalar_inverse(Matrix);
+#endif
+}
+
+mat4x4 transpose(const mat4x4 &Matrix)
+{
+#if GLMATH_SIMD
+	__m128 c0 = _mm_loadu_ps(&Matrix.M[0]);
+	__m128 c1 = _mm_loadu_ps(&Matrix.M[4]);
+	__m128 c2 = _mm_loadu_ps(&Matrix.M[8]);
+	__m128 c3 = _mm_loadu_ps(&Matrix.M[12]);
+
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+	mat4x4 Transpose;
+	_mm_storeu_ps(&Transpose.M[0], c0);
+	_mm_storeu_ps(&Transpose.M[4], c1);
+	_mm_storeu_ps(&Transpose.M[8], c2);
+	_mm_storeu_ps(&Transpose.M[12], c3);
+
+	return Transpose;
+#else
+	return scalar_transpose(Matrix);
+#endif
+}
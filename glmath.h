@@ -515,4 +515,29 @@ mat4x4 perspective(float fovy, float aspect, float n, float f);
 mat4x4 rotate(float angle, const vec3 &u);
 mat4x4 scale(float x, float y, float z);
 mat4x4 translate(float x, float y, float z);
-mat4x4 transpose(const mat4x4 &Matrix);
\ No newline at end of file
+mat4x4 transpose(const mat4x4 &Matrix);
+
+// ----------------------------------------------------------------------------------------------------------------------------
+//
+// Matrix products, inverse, transpose and normalize run on SSE when glmath.cpp is built with it (GLMATH_SIMD). The
+// scalar versions stay available as reference for tests and benchmarks. Everything but inverse matches them bit for
+// bit, inverse differs by rounding only
+//
+// ----------------------------------------------------------------------------------------------------------------------------
+
+// SSE2 is baseline on x64 and the default /arch on x86, anything else takes the scalar path
+#ifndef GLMATH_SIMD
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define GLMATH_SIMD 1
+#else
+#define GLMATH_SIMD 0
+#endif
+#endif
+
+bool simd_enabled();
+
+vec3 scalar_normalize(const vec3 &u);
+mat4x4 scalar_multiply(const mat4x4 &Matrix1, const mat4x4 &Matrix2);
+vec4 scalar_multiply(const mat4x4 &Matrix, const vec4 &u);
+mat4x4 scalar_inverse(const mat4x4 &Matrix);
+mat4x4 scalar_transpose(const mat4x4 &Matrix);
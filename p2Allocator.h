@@ -0,0 +1,45 @@
+#pragma once
+// ----------------------------------------------------
+// Allocators for the p2 containers  ------------------
+// ----------------------------------------------------
+
+#ifndef __P2ALLOCATOR_H__
+#define __P2ALLOCATOR_H__
+
+#include <assert.h>
+#include <stddef.h>
+#include <new>
+
+// Containers take an allocator by value and call
+//   void* Allocate(size_t bytes, size_t alignment)
+//   void Free(void* ptr, size_t bytes, size_t alignment)
+// on it. Stateful allocators (arenas, pools) hold a pointer to their storage
+
+// General purpose heap, honouring alignments above what operator new guarantees
+struct p2SystemAllocator
+{
+	void* Allocate(size_t bytes, size_t alignment)
+	{
+		if(alignment <= alignof(max_align_t))
+			return ::operator new(bytes);
+
+		// Over-allocate and keep the real block address right before the aligned one
+		char* block = static_cast<char*>(::operator new(bytes + alignment + sizeof(void*)));
+		size_t aligned = ((size_t)(block + sizeof(void*)) + alignment - 1) & ~(alignment - 1);
+		((void**)aligned)[-1] = block;
+		return (void*)aligned;
+	}
+
+	void Free(void* ptr, size_t bytes, size_t alignment)
+	{
+		if(ptr == NULL)
+			return;
+
+		if(alignment <= alignof(max_align_t))
+			::operator delete(ptr);
+		else
+			::operator delete(((void**)ptr)[-1]);
+	}
+};
+
+#endif // __P2ALLOCATOR_H__
@@ -1,3 +1,4 @@
+#pragma once
 // ----------------------------------------------------
 // Array that resizes dynamically   -------------------
 // ----------------------------------------------------
@@ -6,10 +7,17 @@
 #define __P2DYNARRAY_H__
 
 #include <assert.h>
+#include <new>
+#include <string.h>
+#include <utility>
+#include <type_traits>
+#include "p2Allocator.h"
 
 #define DYN_ARRAY_BLOCK_SIZE 16
 
-template<class VALUE>
+// Capacity doubles when full (starting at DYN_ARRAY_BLOCK_SIZE) and memory
+// comes from ALLOCATOR, see p2Allocator.h for the interface
+template<class VALUE, class ALLOCATOR = p2SystemAllocator>
 class p2DynArray
 {
 private:
@@ -17,32 +25,37 @@ private:
 	VALUE*			data;
 	unsigned int	mem_capacity;
 	unsigned int	num_elements;
+	ALLOCATOR		allocator;
 
 public:
 
 	// Constructors
-	p2DynArray() : mem_capacity(0), num_elements(0), data(NULL)
-	{
-		Alloc(DYN_ARRAY_BLOCK_SIZE);
-	}
+	p2DynArray(const ALLOCATOR& allocator = ALLOCATOR()) : data(NULL), mem_capacity(0), num_elements(0), allocator(allocator)
+	{}
 
-	p2DynArray(unsigned int capacity) : mem_capacity(0), num_elements(0), data(NULL)
+	p2DynArray(unsigned int capacity, const ALLOCATOR& allocator = ALLOCATOR()) : data(NULL), mem_capacity(0), num_elements(0), allocator(allocator)
 	{
 		Alloc(capacity);
 	}
 
-	p2DynArray(const p2DynArray& array) : mem_capacity(0), num_elements(0), data(NULL)
+	p2DynArray(const p2DynArray& array) : data(NULL), mem_capacity(0), num_elements(0), allocator(array.allocator)
 	{
 		Alloc(array.num_elements);
+		CopyFrom(array);
+	}
 
-		for(unsigned int i = 0; i < array.num_elements; ++i)
-			PushBack(array.data[i]);
+	p2DynArray(p2DynArray&& array) : data(array.data), mem_capacity(array.mem_capacity), num_elements(array.num_elements), allocator(std::move(array.allocator))
+	{
+		array.data = NULL;
+		array.mem_capacity = 0;
+		array.num_elements = 0;
 	}
 
 	// Destructor
 	~p2DynArray()
 	{
-		delete[] data;
+		Clear();
+		allocator.Free(data, mem_capacity * sizeof(VALUE), alignof(VALUE));
 	}
 
 	// Operators
@@ -58,13 +71,33 @@ public:
 		return data[index];
 	}
 
-	const p2DynArray<VALUE>& operator=(const p2DynArray<VALUE>& other)
+	const p2DynArray& operator=(const p2DynArray& other)
 	{
-		Alloc(other.num_elements);
+		if(this != &other)
+		{
+			Clear();
+			Reserve(other.num_elements);
+			CopyFrom(other);
+		}
+		return *this;
+	}
 
-		for(unsigned int i = 0; i < other.num_elements; ++i)
-			PushBack(other.data[i]);
+	const p2DynArray& operator=(p2DynArray&& other)
+	{
+		if(this != &other)
+		{
+			Clear();
+			allocator.Free(data, mem_capacity * sizeof(VALUE), alignof(VALUE));
+
+			data = other.data;
+			mem_capacity = other.mem_capacity;
+			num_elements = other.num_elements;
+			allocator = std::move(other.allocator);
 
+			other.data = NULL;
+			other.mem_capacity = 0;
+			other.num_elements = 0;
+		}
 		return *this;
 	}
 
@@ -73,19 +106,42 @@ public:
 	{
 		if(num_elements >= mem_capacity)
 		{
-			Alloc(mem_capacity + DYN_ARRAY_BLOCK_SIZE);
+			// element may live in this array, copy it before growing
+			VALUE copy(element);
+			Grow();
+			new (&data[num_elements++]) VALUE(std::move(copy));
+		}
+		else
+		{
+			new (&data[num_elements++]) VALUE(element);
 		}
 
-		data[num_elements++] = element;
+		return data[num_elements - 1];
+	}
+
+	void PushBack(VALUE&& element)
+	{
+		if(num_elements >= mem_capacity)
+			Grow();
+
+		new (&data[num_elements++]) VALUE(std::move(element));
+	}
 
-		return element;
+	template<class... ARGS>
+	VALUE& EmplaceBack(ARGS&&... args)
+	{
+		if(num_elements >= mem_capacity)
+			Grow();
+
+		return *new (&data[num_elements++]) VALUE(std::forward<ARGS>(args)...);
 	}
 
 	bool Pop(VALUE& value)
 	{
 		if(num_elements > 0)
 		{
-			value = data[--num_elements];
+			value = std::move(data[--num_elements]);
+			data[num_elements].~VALUE();
 			return true;
 		}
 		return false;
@@ -93,6 +149,9 @@ public:
 
 	void Clear()
 	{
+		for(unsigned int i = 0; i < num_elements; ++i)
+			data[i].~VALUE();
+
 		num_elements = 0;
 	}
 
@@ -107,15 +166,19 @@ public:
 			return true;
 		}
 
+		VALUE copy(element);
+
 		if(num_elements + 1 > mem_capacity)
-			Alloc(mem_capacity + DYN_ARRAY_BLOCK_SIZE);
+			Grow();
+
+		new (&data[num_elements]) VALUE(std::move(data[num_elements - 1]));
 
-		for(unsigned int i = num_elements; i > position; --i)
+		for(unsigned int i = num_elements - 1; i > position; --i)
 		{
-			data[i] = data[i - 1];
+			data[i] = std::move(data[i - 1]);
 		}
 
-		data[position] = element;
+		data[position] = std::move(copy);
 		++num_elements;
 
 		return true;
@@ -133,7 +196,7 @@ public:
 
 	const VALUE* At(unsigned int index) const
 	{
-		VALUE* result = NULL;
+		const VALUE* result = NULL;
 
 		if(index < num_elements)
 			return result = &data[index];
@@ -141,6 +204,19 @@ public:
 		return result;
 	}
 
+	void Reserve(unsigned int capacity)
+	{
+		if(capacity > mem_capacity)
+			Alloc(capacity);
+	}
+
+	// Gives back the memory not used by the current elements
+	void ShrinkToFit()
+	{
+		if(num_elements < mem_capacity)
+			Alloc(num_elements);
+	}
+
 	// Utils
 	unsigned int GetCapacity() const
 	{
@@ -152,27 +228,96 @@ public:
 		return num_elements;
 	}
 
+	VALUE* GetData()
+	{
+		return data;
+	}
+
+	const VALUE* GetData() const
+	{
+		return data;
+	}
+
+	// Range for support
+	VALUE* begin()
+	{
+		return data;
+	}
+
+	VALUE* end()
+	{
+		return data + num_elements;
+	}
+
+	const VALUE* begin() const
+	{
+		return data;
+	}
+
+	const VALUE* end() const
+	{
+		return data + num_elements;
+	}
+
 private:
 	
 	// Private Utils
+	// Expects an empty array with room for all of other's elements
+	void CopyFrom(const p2DynArray& other)
+	{
+		if(std::is_trivially_copyable<VALUE>::value)
+		{
+			if(other.num_elements > 0)
+				memcpy(data, other.data, other.num_elements * sizeof(VALUE));
+			num_elements = other.num_elements;
+		}
+		else
+		{
+			for(unsigned int i = 0; i < other.num_elements; ++i)
+				new (&data[num_elements++]) VALUE(other.data[i]);
+		}
+	}
+
+	void Grow()
+	{
+		Alloc(mem_capacity > 0 ? mem_capacity * 2 : DYN_ARRAY_BLOCK_SIZE);
+	}
+
 	void Alloc(unsigned int mem)
 	{
 		VALUE* tmp = data;
+		unsigned int old_capacity = mem_capacity;
 
-		mem_capacity = mem;
-		data = new VALUE[mem_capacity];
+		if(num_elements > mem)
+		{
+			for(unsigned int i = mem; i < num_elements; ++i)
+				data[i].~VALUE();
 
-		if(num_elements > mem_capacity)
-			num_elements = mem_capacity;
+			num_elements = mem;
+		}
+
+		mem_capacity = mem;
+		data = mem > 0 ? static_cast<VALUE*>(allocator.Allocate(mem * sizeof(VALUE), alignof(VALUE))) : NULL;
 
 		if(tmp != NULL)
 		{
-			for(unsigned int i = 0; i < num_elements; ++i)
-				data[i] = tmp[i];
-
-			delete[] tmp;
+			if(std::is_trivially_copyable<VALUE>::value)
+			{
+				if(num_elements > 0)
+					memcpy(data, tmp, num_elements * sizeof(VALUE));
+			}
+			else
+			{
+				for(unsigned int i = 0; i < num_elements; ++i)
+				{
+					new (&data[i]) VALUE(std::move(tmp[i]));
+					tmp[i].~VALUE();
+				}
+			}
+
+			allocator.Free(tmp, old_capacity * sizeof(VALUE), alignof(VALUE));
 		}
 	}
 };
 
-#endif // __P2DYNARRAY_H__
\ No newline at end of file
+#endif // __P2DYNARRAY_H__
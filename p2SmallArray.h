@@ -0,0 +1,296 @@
+#pragma once
+// ----------------------------------------------------
+// Contiguous growable array with inline storage  -----
+// ----------------------------------------------------
+
+#ifndef __P2SMALLARRAY_H__
+#define __P2SMALLARRAY_H__
+
+#include <assert.h>
+#include <stdlib.h>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+// Elements live in a buffer inside the object until more than INLINE are
+// added, then move to the heap, doubling capacity each time it runs out.
+// Pointers to elements are invalidated by growth and by removal
+template<class VALUE, unsigned int INLINE = 8>
+class p2SmallArray
+{
+private:
+
+	VALUE*			data;
+	unsigned int	mem_capacity;
+	unsigned int	num_elements;
+	typename std::aligned_storage<sizeof(VALUE), alignof(VALUE)>::type inline_buffer[INLINE > 0 ? INLINE : 1];
+
+public:
+
+	// Constructors
+	p2SmallArray() : data(InlineData()), mem_capacity(INLINE), num_elements(0)
+	{}
+
+	p2SmallArray(const p2SmallArray& array) : data(InlineData()), mem_capacity(INLINE), num_elements(0)
+	{
+		Reserve(array.num_elements);
+
+		for(unsigned int i = 0; i < array.num_elements; ++i)
+			PushBack(array.data[i]);
+	}
+
+	p2SmallArray(p2SmallArray&& array) : data(InlineData()), mem_capacity(INLINE), num_elements(0)
+	{
+		Steal(array);
+	}
+
+	// Destructor
+	~p2SmallArray()
+	{
+		Clear();
+		FreeHeap();
+	}
+
+	// Operators
+	p2SmallArray& operator=(const p2SmallArray& other)
+	{
+		if(this != &other)
+		{
+			Clear();
+			Reserve(other.num_elements);
+
+			for(unsigned int i = 0; i < other.num_elements; ++i)
+				PushBack(other.data[i]);
+		}
+		return *this;
+	}
+
+	p2SmallArray& operator=(p2SmallArray&& other)
+	{
+		if(this != &other)
+		{
+			Clear();
+			FreeHeap();
+			Steal(other);
+		}
+		return *this;
+	}
+
+	VALUE& operator[](unsigned int index)
+	{
+		assert(index < num_elements);
+		return data[index];
+	}
+
+	const VALUE& operator[](unsigned int index) const
+	{
+		assert(index < num_elements);
+		return data[index];
+	}
+
+	// Data Management
+	void PushBack(const VALUE& element)
+	{
+		if(num_elements >= mem_capacity)
+		{
+			// element may live in this array, copy it before growing
+			VALUE copy(element);
+			Grow(num_elements + 1);
+			new (&data[num_elements++]) VALUE(std::move(copy));
+			return;
+		}
+
+		new (&data[num_elements++]) VALUE(element);
+	}
+
+	void PushBack(VALUE&& element)
+	{
+		if(num_elements >= mem_capacity)
+			Grow(num_elements + 1);
+
+		new (&data[num_elements++]) VALUE(std::move(element));
+	}
+
+	template<class... ARGS>
+	VALUE& EmplaceBack(ARGS&&... args)
+	{
+		if(num_elements >= mem_capacity)
+			Grow(num_elements + 1);
+
+		return *new (&data[num_elements++]) VALUE(std::forward<ARGS>(args)...);
+	}
+
+	bool Pop(VALUE& value)
+	{
+		if(num_elements > 0)
+		{
+			value = std::move(data[--num_elements]);
+			data[num_elements].~VALUE();
+			return true;
+		}
+		return false;
+	}
+
+	// Keeps the order of the remaining elements
+	void RemoveAt(unsigned int index)
+	{
+		assert(index < num_elements);
+
+		for(unsigned int i = index; i + 1 < num_elements; ++i)
+			data[i] = std::move(data[i + 1]);
+
+		data[--num_elements].~VALUE();
+	}
+
+	// O(1), moves the last element into the hole
+	void RemoveSwap(unsigned int index)
+	{
+		assert(index < num_elements);
+
+		if(index + 1 < num_elements)
+			data[index] = std::move(data[num_elements - 1]);
+
+		data[--num_elements].~VALUE();
+	}
+
+	// Index of the first element equal to value, -1 if not found
+	int Find(const VALUE& value) const
+	{
+		for(unsigned int i = 0; i < num_elements; ++i)
+		{
+			if(data[i] == value)
+				return (int)i;
+		}
+		return -1;
+	}
+
+	void Clear()
+	{
+		for(unsigned int i = 0; i < num_elements; ++i)
+			data[i].~VALUE();
+
+		num_elements = 0;
+	}
+
+	void Reserve(unsigned int capacity)
+	{
+		if(capacity > mem_capacity)
+			Alloc(capacity);
+	}
+
+	// Utils
+	unsigned int GetCapacity() const
+	{
+		return mem_capacity;
+	}
+
+	unsigned int Count() const
+	{
+		return num_elements;
+	}
+
+	bool Empty() const
+	{
+		return num_elements == 0;
+	}
+
+	VALUE* GetData()
+	{
+		return data;
+	}
+
+	const VALUE* GetData() const
+	{
+		return data;
+	}
+
+	// Range for support
+	VALUE* begin()
+	{
+		return data;
+	}
+
+	VALUE* end()
+	{
+		return data + num_elements;
+	}
+
+	const VALUE* begin() const
+	{
+		return data;
+	}
+
+	const VALUE* end() const
+	{
+		return data + num_elements;
+	}
+
+private:
+
+	// Private Utils
+	VALUE* InlineData()
+	{
+		return reinterpret_cast<VALUE*>(inline_buffer);
+	}
+
+	bool IsInline() const
+	{
+		return data == reinterpret_cast<const VALUE*>(inline_buffer);
+	}
+
+	void Grow(unsigned int needed)
+	{
+		unsigned int capacity = mem_capacity > 0 ? mem_capacity * 2 : 8;
+		Alloc(capacity > needed ? capacity : needed);
+	}
+
+	void Alloc(unsigned int mem)
+	{
+		VALUE* tmp = static_cast<VALUE*>(::operator new(mem * sizeof(VALUE)));
+
+		for(unsigned int i = 0; i < num_elements; ++i)
+		{
+			new (&tmp[i]) VALUE(std::move(data[i]));
+			data[i].~VALUE();
+		}
+
+		FreeHeap();
+		data = tmp;
+		mem_capacity = mem;
+	}
+
+	void FreeHeap()
+	{
+		if(IsInline() == false)
+		{
+			::operator delete(data);
+			data = InlineData();
+			mem_capacity = INLINE;
+		}
+	}
+
+	// Takes the heap buffer when there is one, moves element by element otherwise
+	void Steal(p2SmallArray& other)
+	{
+		if(other.IsInline())
+		{
+			for(unsigned int i = 0; i < other.num_elements; ++i)
+				new (&data[i]) VALUE(std::move(other.data[i]));
+
+			num_elements = other.num_elements;
+			other.Clear();
+		}
+		else
+		{
+			data = other.data;
+			mem_capacity = other.mem_capacity;
+			num_elements = other.num_elements;
+
+			other.data = other.InlineData();
+			other.mem_capacity = INLINE;
+			other.num_elements = 0;
+		}
+	}
+};
+
+#endif // __P2SMALLARRAY_H__